@@ -0,0 +1,62 @@
+#include "bit_mask.h"
+#include "mc_common.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// 8 个 0/1 字节压成 8 位：字节 i 放在第 8i 位起，乘法把它移到第 56+i 位，
+// 各部分积位置互不重叠，不会产生进位
+inline uint64_t pack_bytes(const uint8_t *bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    return (v * 0x0102040810204080ULL) >> 56;
+}
+
+} // namespace
+
+template <typename T>
+void BitMaskVolume::build(const T *vol, int nx, int ny, int nz, float iso, int numThreads) {
+    ny_ = ny;
+    wordsPerRow_ = (static_cast<size_t>(nx) + 63) / 64;
+    const size_t rows = static_cast<size_t>(ny) * static_cast<size_t>(nz);
+    bits_.resize(rows * wordsPerRow_);
+
+    const CubeClassifyKernels &kernels = cube_classify_kernels();
+    const VoxelThreshold<T> threshold(iso - 1e-6f);
+    const auto pack_planes = [&](int z0, int z1) {
+        // 行掩码补齐到整字，补齐部分保持为 0
+        std::vector<uint8_t> mask(wordsPerRow_ * 64, 0);
+        for (int z = z0; z < z1; ++z) {
+            for (int y = 0; y < ny; ++y) {
+                const size_t r = static_cast<size_t>(z) * static_cast<size_t>(ny) + static_cast<size_t>(y);
+                threshold.classify(kernels, vol + r * static_cast<size_t>(nx), static_cast<size_t>(nx), mask.data());
+                uint64_t *out = bits_.data() + r * wordsPerRow_;
+                for (size_t w = 0; w < wordsPerRow_; ++w) {
+                    const uint8_t *bytes = mask.data() + w * 64;
+                    uint64_t word = 0;
+                    for (int b = 0; b < 8; ++b) word |= pack_bytes(bytes + b * 8) << (b * 8);
+                    out[w] = word;
+                }
+            }
+        }
+    };
+
+    const int workers = std::max(1, std::min(numThreads, nz));
+    if (workers == 1) {
+        pack_planes(0, nz);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int t = 0; t < workers; ++t) {
+        pool.emplace_back(pack_planes, static_cast<int>(static_cast<int64_t>(nz) * t / workers),
+                          static_cast<int>(static_cast<int64_t>(nz) * (t + 1) / workers));
+    }
+    for (auto &th : pool) th.join();
+}
+
+template void BitMaskVolume::build<float>(const float *, int, int, int, float, int);
+template void BitMaskVolume::build<uint8_t>(const uint8_t *, int, int, int, float, int);
+template void BitMaskVolume::build<int16_t>(const int16_t *, int, int, int, float, int);
+template void BitMaskVolume::build<uint16_t>(const uint16_t *, int, int, int, float, int);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Volume classified against one iso value and packed to one bit per voxel.
+// Bit x of row (y, z) is set when voxel (x, y, z) is below the classification
+// threshold of marching_cubes() (the cube-index convention), so a row of 64
+// cells is classified with a few shifts and ANDs over four rows of words.
+// Rows are padded to whole 64-bit words; padding bits are clear.
+class BitMaskVolume {
+public:
+    // Classify and pack the volume (parallel over z-planes when numThreads > 1).
+    // Instantiated for the same voxel types as marching_cubes().
+    template <typename T>
+    void build(const T *volume, int nx, int ny, int nz, float isoValue, int numThreads = 1);
+
+    size_t words_per_row() const { return wordsPerRow_; }
+    const uint64_t *row(int y, int z) const {
+        return bits_.data() + (static_cast<size_t>(z) * static_cast<size_t>(ny_) + static_cast<size_t>(y)) * wordsPerRow_;
+    }
+
+private:
+    int ny_ = 0;
+    size_t wordsPerRow_ = 0;
+    std::vector<uint64_t> bits_;
+};
@@ -0,0 +1,222 @@
+#include "block_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// NaN 在分类时总被视为“不低于等值”，按 +inf 参与最值统计；整数体素按原值转换
+template <typename T>
+inline float range_value(T v) {
+    return static_cast<float>(v);
+}
+
+template <>
+inline float range_value<float>(float v) {
+    return v == v ? v : std::numeric_limits<float>::infinity();
+}
+
+// 行内是否有 NaN（整数体素不可能有）；没有时可以直接用原值求最值，免去逐元素替换
+template <typename T>
+inline bool has_nan(const T *, int) {
+    return false;
+}
+
+template <>
+inline bool has_nan<float>(const float *row, int n) {
+    int nan = 0;
+    for (int x = 0; x < n; ++x) nan |= row[x] != row[x];
+    return nan != 0;
+}
+
+} // namespace
+
+template <typename T>
+void MinMaxBlockIndex::build(const T *vol, int nx, int ny, int nz, int numThreads, PyramidLevel<T> *halfRes) {
+    build_ranges<false>(vol, vol, nx, ny, nz, numThreads, halfRes);
+}
+
+template <typename T>
+void MinMaxBlockIndex::build(const PyramidLevel<T> &level, int numThreads) {
+    build_ranges<true>(level.minVal.data(), level.maxVal.data(), level.nx, level.ny, level.nz, numThreads,
+                       static_cast<PyramidLevel<T> *>(nullptr));
+}
+
+// 体素以 [minVol, maxVol] 区间给出；kRanges 为 false 时两者是同一体数据，每个体素只读一次
+template <bool kRanges, typename T>
+void MinMaxBlockIndex::build_ranges(const T *minVol, const T *maxVolume, int nx, int ny, int nz, int numThreads,
+                                    PyramidLevel<T> *halfRes) {
+    const T *maxVol = kRanges ? maxVolume : minVol;
+    bx_ = bricks_along(nx);
+    by_ = bricks_along(ny);
+    bz_ = bricks_along(nz);
+    const size_t bricks = static_cast<size_t>(bx_) * by_ * bz_;
+    minVal_.assign(bricks, std::numeric_limits<float>::infinity());
+    maxVal_.assign(bricks, -std::numeric_limits<float>::infinity());
+    if (bricks == 0) {
+        cx_ = cy_ = cz_ = 0;
+        coarseMin_.clear(); coarseMax_.clear();
+        return;
+    }
+
+    const size_t sy = static_cast<size_t>(nx);
+    const size_t sz = sy * static_cast<size_t>(ny);
+
+    // 金字塔 2x 层：粗体素 (x, y, z) 取细体素 2x..2x+1 等 8 个的最值
+    static_assert(kBrickSize % 2 == 0, "a brick layer must hold whole pyramid planes");
+    if (halfRes) {
+        halfRes->nx = (nx + 1) / 2; halfRes->ny = (ny + 1) / 2; halfRes->nz = (nz + 1) / 2;
+        halfRes->scale = 2;
+        halfRes->minVal.resize(static_cast<size_t>(halfRes->nx) * halfRes->ny * halfRes->nz);
+        halfRes->maxVal.resize(halfRes->minVal.size());
+    }
+    // 细行 (y, z) 两两归并后并入粗行 (y/2, z/2)；每个粗行最先遇到的是 y、z 均为偶数的细行
+    const auto reduce_row = [&](const T *minRow, const T *maxRow, int y, int z) {
+        const size_t offset = (static_cast<size_t>(z / 2) * halfRes->ny + y / 2) * halfRes->nx;
+        T *outMin = halfRes->minVal.data() + offset;
+        T *outMax = halfRes->maxVal.data() + offset;
+        const int pairs = nx / 2;
+        const bool first = y % 2 == 0 && z % 2 == 0;
+        const auto reduce = [&](auto value) {
+            if (first) {
+                for (int x = 0; x < pairs; ++x) {
+                    outMin[x] = std::min(value(minRow[2 * x]), value(minRow[2 * x + 1]));
+                    outMax[x] = std::max(value(maxRow[2 * x]), value(maxRow[2 * x + 1]));
+                }
+                if (nx % 2) {
+                    outMin[pairs] = value(minRow[nx - 1]);
+                    outMax[pairs] = value(maxRow[nx - 1]);
+                }
+            } else {
+                for (int x = 0; x < pairs; ++x) {
+                    outMin[x] = std::min(outMin[x], std::min(value(minRow[2 * x]), value(minRow[2 * x + 1])));
+                    outMax[x] = std::max(outMax[x], std::max(value(maxRow[2 * x]), value(maxRow[2 * x + 1])));
+                }
+                if (nx % 2) {
+                    outMin[pairs] = std::min(outMin[pairs], value(minRow[nx - 1]));
+                    outMax[pairs] = std::max(outMax[pairs], value(maxRow[nx - 1]));
+                }
+            }
+        };
+        if (has_nan(minRow, nx) || (kRanges && has_nan(maxRow, nx))) {
+            reduce([](T v) { return static_cast<T>(range_value(v)); });
+        } else {
+            reduce([](T v) { return v; });
+        }
+    };
+
+    // 处理一层 brick (bz)：体素 z ∈ [bz*B, min(bz*B+B, nz-1)]；每行先求各 brick 的
+    // x 段最值（相邻段共享边界体素），再归并到覆盖该行的 1~2 个 brick 行
+    const auto build_layer = [&](int bz) {
+        std::vector<float> segMin(static_cast<size_t>(bx_)), segMax(static_cast<size_t>(bx_));
+        const int zBegin = bz * kBrickSize;
+        const int zEnd = std::min(zBegin + kBrickSize, nz - 1);
+        const auto process_row = [&](int y, int z) {
+            const size_t rowOffset = static_cast<size_t>(z) * sz + static_cast<size_t>(y) * sy;
+            const T *minRow = minVol + rowOffset, *maxRow = maxVol + rowOffset;
+            // 与下一层共享的边界平面归下一层（最后一层除外）并入金字塔
+            if (halfRes && (z < zBegin + kBrickSize || bz == bz_ - 1)) reduce_row(minRow, maxRow, y, z);
+            for (int b = 0; b < bx_; ++b) {
+                const int xBegin = b * kBrickSize;
+                const int xEnd = std::min(xBegin + kBrickSize, nx - 1);
+                float mn = range_value(minRow[xBegin]), mx = kRanges ? range_value(maxRow[xBegin]) : mn;
+                for (int x = xBegin + 1; x <= xEnd; ++x) {
+                    const float v = range_value(minRow[x]);
+                    mn = std::min(mn, v);
+                    mx = std::max(mx, kRanges ? range_value(maxRow[x]) : v);
+                }
+                segMin[static_cast<size_t>(b)] = mn;
+                segMax[static_cast<size_t>(b)] = mx;
+            }
+            // 行 y 属于 brick 行 y/B，若恰在边界上也属于前一个 brick 行
+            const int byHi = std::min(y / kBrickSize, by_ - 1);
+            const int byLo = (y % kBrickSize == 0 && y > 0) ? y / kBrickSize - 1 : byHi;
+            for (int byi = byLo; byi <= byHi; ++byi) {
+                const size_t base = (static_cast<size_t>(bz) * by_ + byi) * bx_;
+                for (int b = 0; b < bx_; ++b) {
+                    minVal_[base + b] = std::min(minVal_[base + b], segMin[static_cast<size_t>(b)]);
+                    maxVal_[base + b] = std::max(maxVal_[base + b], segMax[static_cast<size_t>(b)]);
+                }
+            }
+        };
+        // 两个 z 平面的同一行交替处理，金字塔粗行在缓存中完成归并
+        for (int z = zBegin; z <= zEnd; z += 2) {
+            for (int y = 0; y < ny; ++y) {
+                process_row(y, z);
+                if (z + 1 <= zEnd) process_row(y, z + 1);
+            }
+        }
+    };
+
+    const int workers = std::max(1, std::min(numThreads, bz_));
+    if (workers == 1) {
+        for (int bz = 0; bz < bz_; ++bz) build_layer(bz);
+    } else {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < workers; ++t) {
+            pool.emplace_back([&, t]() {
+                for (int bz = t; bz < bz_; bz += workers) build_layer(bz);
+            });
+        }
+        for (auto &th : pool) th.join();
+    }
+
+    // 粗层：每 kCoarseFactor^3 个 brick 归并一次
+    cx_ = (bx_ + kCoarseFactor - 1) / kCoarseFactor;
+    cy_ = (by_ + kCoarseFactor - 1) / kCoarseFactor;
+    cz_ = (bz_ + kCoarseFactor - 1) / kCoarseFactor;
+    const size_t coarse = static_cast<size_t>(cx_) * cy_ * cz_;
+    coarseMin_.assign(coarse, std::numeric_limits<float>::infinity());
+    coarseMax_.assign(coarse, -std::numeric_limits<float>::infinity());
+    for (int bz = 0; bz < bz_; ++bz) {
+        for (int byi = 0; byi < by_; ++byi) {
+            for (int bxi = 0; bxi < bx_; ++bxi) {
+                const size_t fine = (static_cast<size_t>(bz) * by_ + byi) * bx_ + bxi;
+                const size_t c = (static_cast<size_t>(bz / kCoarseFactor) * cy_ + byi / kCoarseFactor) * cx_
+                               + bxi / kCoarseFactor;
+                coarseMin_[c] = std::min(coarseMin_[c], minVal_[fine]);
+                coarseMax_[c] = std::max(coarseMax_[c], maxVal_[fine]);
+            }
+        }
+    }
+}
+
+template void MinMaxBlockIndex::build<float>(const float *, int, int, int, int, PyramidLevel<float> *);
+template void MinMaxBlockIndex::build<float>(const PyramidLevel<float> &, int);
+template void MinMaxBlockIndex::build<uint8_t>(const uint8_t *, int, int, int, int, PyramidLevel<uint8_t> *);
+template void MinMaxBlockIndex::build<uint8_t>(const PyramidLevel<uint8_t> &, int);
+template void MinMaxBlockIndex::build<int16_t>(const int16_t *, int, int, int, int, PyramidLevel<int16_t> *);
+template void MinMaxBlockIndex::build<int16_t>(const PyramidLevel<int16_t> &, int);
+template void MinMaxBlockIndex::build<uint16_t>(const uint16_t *, int, int, int, int, PyramidLevel<uint16_t> *);
+template void MinMaxBlockIndex::build<uint16_t>(const PyramidLevel<uint16_t> &, int);
+
+void MinMaxBlockIndex::find_active(float iso, ActiveBricks &out) const {
+    out.bricksX = bx_;
+    out.bricksY = by_;
+    out.bricksZ = bz_;
+    out.active.assign(minVal_.size(), 0);
+    out.activeCount = 0;
+    for (int cz = 0; cz < cz_; ++cz) {
+        for (int cy = 0; cy < cy_; ++cy) {
+            for (int cx = 0; cx < cx_; ++cx) {
+                const size_t c = (static_cast<size_t>(cz) * cy_ + cy) * cx_ + cx;
+                if (!brick_straddles(coarseMin_[c], coarseMax_[c], iso)) continue;
+                const int zEnd = std::min((cz + 1) * kCoarseFactor, bz_);
+                const int yEnd = std::min((cy + 1) * kCoarseFactor, by_);
+                const int xEnd = std::min((cx + 1) * kCoarseFactor, bx_);
+                for (int bz = cz * kCoarseFactor; bz < zEnd; ++bz) {
+                    for (int byi = cy * kCoarseFactor; byi < yEnd; ++byi) {
+                        for (int bxi = cx * kCoarseFactor; bxi < xEnd; ++bxi) {
+                            const size_t fine = (static_cast<size_t>(bz) * by_ + byi) * bx_ + bxi;
+                            if (brick_straddles(minVal_[fine], maxVal_[fine], iso)) {
+                                out.active[fine] = 1;
+                                ++out.activeCount;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "volume_pyramid.h"
+
+// Hierarchical min/max index for empty-space skipping.
+// The cell grid ((nx-1) x (ny-1) x (nz-1) cells) is split into bricks of
+// kBrickSize^3 cells; each brick stores the value range of the voxels its cells
+// touch (kBrickSize+1 per axis, shared with the neighbour). A coarse level groups
+// kCoarseFactor^3 bricks so that empty regions are rejected with one test.
+// Build once per volume, then query any number of iso values.
+
+constexpr int kBrickSize = 8;
+constexpr int kCoarseFactor = 8;
+
+// Bricks whose value range straddles the iso value, laid out as bz, by, bx.
+struct ActiveBricks {
+    int bricksX = 0, bricksY = 0, bricksZ = 0;
+    std::vector<uint8_t> active;
+    size_t activeCount = 0;
+
+    bool is_active(int bx, int by, int bz) const {
+        return active[(static_cast<size_t>(bz) * bricksY + by) * bricksX + bx] != 0;
+    }
+};
+
+// Number of bricks needed along an axis with n voxels.
+inline int bricks_along(int n) { return n < 2 ? 0 : (n - 2) / kBrickSize + 1; }
+
+// A brick intersects the surface when it holds voxels on both sides of the
+// classification threshold used by marching_cubes() (value < iso - 1e-6f).
+inline bool brick_straddles(float mn, float mx, float iso) {
+    const float isoBias = iso - 1e-6f;
+    return mn < isoBias && !(mx < isoBias);
+}
+
+class MinMaxBlockIndex {
+public:
+    MinMaxBlockIndex() = default;
+
+    // Scan the volume once (parallel over brick layers when numThreads > 1).
+    // When halfRes is given, the same sweep also fills the 2x level of the
+    // min/max pyramid (volume_pyramid.h); the volume must satisfy can_downsample().
+    // Instantiated for the same voxel types as marching_cubes().
+    template <typename T>
+    void build(const T *volume, int nx, int ny, int nz, int numThreads = 1, PyramidLevel<T> *halfRes = nullptr);
+
+    // Index a pyramid level: a brick covers the union of its voxels' [min, max]
+    // ranges, which bounds the field pyramid_level_field() derives for any iso value.
+    template <typename T>
+    void build(const PyramidLevel<T> &level, int numThreads = 1);
+
+    // Mark bricks that can contain part of the isosurface.
+    void find_active(float isoValue, ActiveBricks &out) const;
+
+    int bricks_x() const { return bx_; }
+    int bricks_y() const { return by_; }
+    int bricks_z() const { return bz_; }
+    size_t brick_count() const { return minVal_.size(); }
+    float brick_min(size_t i) const { return minVal_[i]; }
+    float brick_max(size_t i) const { return maxVal_[i]; }
+
+private:
+    template <bool kRanges, typename T>
+    void build_ranges(const T *minVolume, const T *maxVolume, int nx, int ny, int nz, int numThreads,
+                      PyramidLevel<T> *halfRes);
+
+    int bx_ = 0, by_ = 0, bz_ = 0;          // fine level: bricks per axis
+    int cx_ = 0, cy_ = 0, cz_ = 0;          // coarse level: blocks per axis
+    std::vector<float> minVal_, maxVal_;    // fine level, bz, by, bx order
+    std::vector<float> coarseMin_, coarseMax_;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Parallel chunked encoding for the mesh writers.
+// Elements [0, count) are split into chunks of kEncodeChunk; up to numThreads
+// chunks are encoded concurrently into separate buffers, and the buffers are
+// written to the stream in order with one write() each. encode(begin, end, buf)
+// replaces buf with the bytes of elements [begin, end).
+
+constexpr size_t kEncodeChunk = size_t(1) << 16;
+
+template <typename EncodeFn>
+bool write_chunked(std::ostream &out, size_t count, int numThreads, EncodeFn &&encode) {
+    const size_t chunks = (count + kEncodeChunk - 1) / kEncodeChunk;
+    const size_t batch = static_cast<size_t>(std::max(1, numThreads));
+    std::vector<std::string> buffers(std::min(batch, std::max<size_t>(chunks, 1)));
+    for (size_t first = 0; first < chunks && out; first += batch) {
+        const size_t n = std::min(batch, chunks - first);
+        const auto run = [&](size_t i) {
+            const size_t begin = (first + i) * kEncodeChunk;
+            encode(begin, std::min(begin + kEncodeChunk, count), buffers[i]);
+        };
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < n; ++i) workers.emplace_back(run, i);
+        run(0);
+        for (auto &w : workers) w.join();
+        for (size_t i = 0; i < n; ++i) out.write(buffers[i].data(), static_cast<std::streamsize>(buffers[i].size()));
+    }
+    return static_cast<bool>(out);
+}
+
+inline bool host_is_big_endian() {
+    const uint16_t probe = 1;
+    uint8_t first = 0;
+    std::memcpy(&first, &probe, 1);
+    return first == 0;
+}
+
+// Append the 4 bytes of a 32-bit value in big-endian order.
+inline char *put_be32(char *p, uint32_t v) {
+    p[0] = static_cast<char>(v >> 24);
+    p[1] = static_cast<char>(v >> 16);
+    p[2] = static_cast<char>(v >> 8);
+    p[3] = static_cast<char>(v);
+    return p + 4;
+}
+
+inline char *put_be32(char *p, float f) {
+    uint32_t v;
+    std::memcpy(&v, &f, 4);
+    return put_be32(p, v);
+}
+
+// Append the 4 bytes of a 32-bit value in little-endian order.
+inline char *put_le32(char *p, uint32_t v) {
+    p[0] = static_cast<char>(v);
+    p[1] = static_cast<char>(v >> 8);
+    p[2] = static_cast<char>(v >> 16);
+    p[3] = static_cast<char>(v >> 24);
+    return p + 4;
+}
+
+inline char *put_le32(char *p, float f) {
+    uint32_t v;
+    std::memcpy(&v, &f, 4);
+    return put_le32(p, v);
+}
+
+// Corners of a mesh face (MCTriangle, MCTriangle64 or MCQuad), for writers that
+// accept both triangles and quads.
+template <typename Face>
+constexpr size_t kFaceCorners = sizeof(Face) / sizeof(Face::a);
+
+template <typename Face>
+inline std::array<decltype(Face::a), kFaceCorners<Face>> face_corners(const Face &f) {
+    std::array<decltype(Face::a), kFaceCorners<Face>> c;
+    std::memcpy(c.data(), &f, sizeof(Face));
+    return c;
+}
@@ -0,0 +1,293 @@
+#include "cube_classify.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MC_HAVE_AVX2_KERNEL 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#define MC_HAVE_NEON_KERNEL 1
+#endif
+
+namespace {
+
+inline int cube_at(const uint8_t *b00, const uint8_t *b01, const uint8_t *b10, const uint8_t *b11, size_t x) {
+    return  b00[x]
+         | (b00[x + 1] << 1)
+         | (b01[x + 1] << 2)
+         | (b01[x]     << 3)
+         | (b10[x]     << 4)
+         | (b10[x + 1] << 5)
+         | (b11[x + 1] << 6)
+         | (b11[x]     << 7);
+}
+
+// 标量尾部/回退：处理 [x, cells) 的单元
+size_t build_cube_tail(const uint8_t *b00, const uint8_t *b01, const uint8_t *b10, const uint8_t *b11,
+                       size_t x, size_t cells, uint8_t *cubes, uint64_t *active) {
+    size_t count = 0;
+    for (; x < cells; ++x) {
+        const int c = cube_at(b00, b01, b10, b11, x);
+        cubes[x] = static_cast<uint8_t>(c);
+        if (c != 0 && c != 255) {
+            active[x >> 6] |= uint64_t(1) << (x & 63);
+            ++count;
+        }
+    }
+    return count;
+}
+
+void classify_below_scalar(const float *src, size_t n, float isoBias, uint8_t *mask) {
+    for (size_t i = 0; i < n; ++i) mask[i] = src[i] < isoBias ? 1 : 0;
+}
+
+template <typename T>
+void classify_below_int_scalar(const T *src, size_t n, T threshold, uint8_t *mask) {
+    for (size_t i = 0; i < n; ++i) mask[i] = src[i] < threshold ? 1 : 0;
+}
+
+size_t build_cube_row_scalar(const uint8_t *b00, const uint8_t *b01, const uint8_t *b10, const uint8_t *b11,
+                             size_t cells, uint8_t *cubes, uint64_t *active) {
+    std::memset(active, 0, ((cells + 63) / 64) * sizeof(uint64_t));
+    return build_cube_tail(b00, b01, b10, b11, 0, cells, cubes, active);
+}
+
+#if defined(MC_HAVE_AVX2_KERNEL)
+
+__attribute__((target("avx2")))
+void classify_below_avx2(const float *src, size_t n, float isoBias, uint8_t *mask) {
+    const __m256 iso = _mm256_set1_ps(isoBias);
+    const __m256i one = _mm256_set1_epi8(1);
+    // packs 在 128 位通道内交错，最终按 0,4,1,5,2,6,3,7 重排 32 位块恢复顺序
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i m0 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + i),      iso, _CMP_LT_OQ));
+        const __m256i m1 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + i + 8),  iso, _CMP_LT_OQ));
+        const __m256i m2 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + i + 16), iso, _CMP_LT_OQ));
+        const __m256i m3 = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + i + 24), iso, _CMP_LT_OQ));
+        const __m256i w01 = _mm256_packs_epi32(m0, m1);
+        const __m256i w23 = _mm256_packs_epi32(m2, m3);
+        const __m256i b = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(w01, w23), order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(mask + i), _mm256_and_si256(b, one));
+    }
+    classify_below_scalar(src + i, n - i, isoBias, mask + i);
+}
+
+// 无符号比较 v < t（t >= 1）改写为 min(v, t-1) == v
+__attribute__((target("avx2")))
+void classify_below_u8_avx2(const uint8_t *src, size_t n, uint8_t threshold, uint8_t *mask) {
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(threshold - 1));
+    const __m256i one = _mm256_set1_epi8(1);
+    size_t i = 0;
+    if (threshold > 0) {
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            const __m256i below = _mm256_cmpeq_epi8(_mm256_min_epu8(v, limit), v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(mask + i), _mm256_and_si256(below, one));
+        }
+    }
+    classify_below_int_scalar(src + i, n - i, threshold, mask + i);
+}
+
+// 16 位比较结果经 packs 压成字节，再按 64 位块 0,2,1,3 重排恢复顺序
+__attribute__((target("avx2")))
+inline void store_mask16_avx2(uint8_t *mask, __m256i m0, __m256i m1) {
+    const __m256i b = _mm256_permute4x64_epi64(_mm256_packs_epi16(m0, m1), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(mask), _mm256_and_si256(b, _mm256_set1_epi8(1)));
+}
+
+__attribute__((target("avx2")))
+void classify_below_i16_avx2(const int16_t *src, size_t n, int16_t threshold, uint8_t *mask) {
+    const __m256i t = _mm256_set1_epi16(threshold);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 16));
+        store_mask16_avx2(mask + i, _mm256_cmpgt_epi16(t, v0), _mm256_cmpgt_epi16(t, v1));
+    }
+    classify_below_int_scalar(src + i, n - i, threshold, mask + i);
+}
+
+__attribute__((target("avx2")))
+void classify_below_u16_avx2(const uint16_t *src, size_t n, uint16_t threshold, uint8_t *mask) {
+    const __m256i limit = _mm256_set1_epi16(static_cast<short>(threshold - 1));
+    size_t i = 0;
+    if (threshold > 0) {
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 16));
+            store_mask16_avx2(mask + i, _mm256_cmpeq_epi16(_mm256_min_epu16(v0, limit), v0),
+                                        _mm256_cmpeq_epi16(_mm256_min_epu16(v1, limit), v1));
+        }
+    }
+    classify_below_int_scalar(src + i, n - i, threshold, mask + i);
+}
+
+// 掩码字节为 0/1，按 16 位通道左移 k<8 位不会越过字节边界
+__attribute__((target("avx2")))
+inline __m256i load_shifted(const uint8_t *p, int k) {
+    return _mm256_sll_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), _mm_cvtsi32_si128(k));
+}
+
+__attribute__((target("avx2")))
+size_t build_cube_row_avx2(const uint8_t *b00, const uint8_t *b01, const uint8_t *b10, const uint8_t *b11,
+                           size_t cells, uint8_t *cubes, uint64_t *active) {
+    std::memset(active, 0, ((cells + 63) / 64) * sizeof(uint64_t));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi8(static_cast<char>(0xFF));
+    size_t count = 0;
+    size_t x = 0;
+    for (; x + 32 <= cells; x += 32) {
+        __m256i c = load_shifted(b00 + x, 0);
+        c = _mm256_or_si256(c, load_shifted(b00 + x + 1, 1));
+        c = _mm256_or_si256(c, load_shifted(b01 + x + 1, 2));
+        c = _mm256_or_si256(c, load_shifted(b01 + x, 3));
+        c = _mm256_or_si256(c, load_shifted(b10 + x, 4));
+        c = _mm256_or_si256(c, load_shifted(b10 + x + 1, 5));
+        c = _mm256_or_si256(c, load_shifted(b11 + x + 1, 6));
+        c = _mm256_or_si256(c, load_shifted(b11 + x, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(cubes + x), c);
+
+        // 全空 (0) 或全满 (255) 的单元不产生顶点，movemask 一次跳过整段
+        const __m256i inactive = _mm256_or_si256(_mm256_cmpeq_epi8(c, zero), _mm256_cmpeq_epi8(c, full));
+        const uint32_t bits = ~static_cast<uint32_t>(_mm256_movemask_epi8(inactive));
+        if (bits) {
+            active[x >> 6] |= static_cast<uint64_t>(bits) << (x & 63);
+            count += static_cast<size_t>(__builtin_popcount(bits));
+        }
+    }
+    return count + build_cube_tail(b00, b01, b10, b11, x, cells, cubes, active);
+}
+
+bool cpu_has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif // MC_HAVE_AVX2_KERNEL
+
+#if defined(MC_HAVE_NEON_KERNEL)
+
+void classify_below_neon(const float *src, size_t n, float isoBias, uint8_t *mask) {
+    const float32x4_t iso = vdupq_n_f32(isoBias);
+    const uint8x16_t one = vdupq_n_u8(1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint32x4_t m0 = vcltq_f32(vld1q_f32(src + i),      iso);
+        const uint32x4_t m1 = vcltq_f32(vld1q_f32(src + i + 4),  iso);
+        const uint32x4_t m2 = vcltq_f32(vld1q_f32(src + i + 8),  iso);
+        const uint32x4_t m3 = vcltq_f32(vld1q_f32(src + i + 12), iso);
+        const uint16x8_t w01 = vcombine_u16(vmovn_u32(m0), vmovn_u32(m1));
+        const uint16x8_t w23 = vcombine_u16(vmovn_u32(m2), vmovn_u32(m3));
+        const uint8x16_t b = vcombine_u8(vmovn_u16(w01), vmovn_u16(w23));
+        vst1q_u8(mask + i, vandq_u8(b, one));
+    }
+    classify_below_scalar(src + i, n - i, isoBias, mask + i);
+}
+
+void classify_below_u8_neon(const uint8_t *src, size_t n, uint8_t threshold, uint8_t *mask) {
+    const uint8x16_t t = vdupq_n_u8(threshold);
+    const uint8x16_t one = vdupq_n_u8(1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) vst1q_u8(mask + i, vandq_u8(vcltq_u8(vld1q_u8(src + i), t), one));
+    classify_below_int_scalar(src + i, n - i, threshold, mask + i);
+}
+
+void classify_below_i16_neon(const int16_t *src, size_t n, int16_t threshold, uint8_t *mask) {
+    const int16x8_t t = vdupq_n_s16(threshold);
+    const uint8x16_t one = vdupq_n_u8(1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t b = vcombine_u8(vmovn_u16(vcltq_s16(vld1q_s16(src + i), t)),
+                                         vmovn_u16(vcltq_s16(vld1q_s16(src + i + 8), t)));
+        vst1q_u8(mask + i, vandq_u8(b, one));
+    }
+    classify_below_int_scalar(src + i, n - i, threshold, mask + i);
+}
+
+void classify_below_u16_neon(const uint16_t *src, size_t n, uint16_t threshold, uint8_t *mask) {
+    const uint16x8_t t = vdupq_n_u16(threshold);
+    const uint8x16_t one = vdupq_n_u8(1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t b = vcombine_u8(vmovn_u16(vcltq_u16(vld1q_u16(src + i), t)),
+                                         vmovn_u16(vcltq_u16(vld1q_u16(src + i + 8), t)));
+        vst1q_u8(mask + i, vandq_u8(b, one));
+    }
+    classify_below_int_scalar(src + i, n - i, threshold, mask + i);
+}
+
+size_t build_cube_row_neon(const uint8_t *b00, const uint8_t *b01, const uint8_t *b10, const uint8_t *b11,
+                           size_t cells, uint8_t *cubes, uint64_t *active) {
+    std::memset(active, 0, ((cells + 63) / 64) * sizeof(uint64_t));
+    // NEON 没有 movemask：与位权相与后横向求和得到 16 位掩码
+    static const uint8_t kWeights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t weights = vld1q_u8(kWeights);
+    const uint8x16_t full = vdupq_n_u8(0xFF);
+    size_t count = 0;
+    size_t x = 0;
+    for (; x + 16 <= cells; x += 16) {
+        uint8x16_t c = vld1q_u8(b00 + x);
+        c = vorrq_u8(c, vshlq_n_u8(vld1q_u8(b00 + x + 1), 1));
+        c = vorrq_u8(c, vshlq_n_u8(vld1q_u8(b01 + x + 1), 2));
+        c = vorrq_u8(c, vshlq_n_u8(vld1q_u8(b01 + x), 3));
+        c = vorrq_u8(c, vshlq_n_u8(vld1q_u8(b10 + x), 4));
+        c = vorrq_u8(c, vshlq_n_u8(vld1q_u8(b10 + x + 1), 5));
+        c = vorrq_u8(c, vshlq_n_u8(vld1q_u8(b11 + x + 1), 6));
+        c = vorrq_u8(c, vshlq_n_u8(vld1q_u8(b11 + x), 7));
+        vst1q_u8(cubes + x, c);
+
+        const uint8x16_t inactive = vorrq_u8(vceqzq_u8(c), vceqq_u8(c, full));
+        const uint8x16_t act = vandq_u8(vmvnq_u8(inactive), weights);
+        const uint32_t bits = static_cast<uint32_t>(vaddv_u8(vget_low_u8(act)))
+                            | (static_cast<uint32_t>(vaddv_u8(vget_high_u8(act))) << 8);
+        if (bits) {
+            active[x >> 6] |= static_cast<uint64_t>(bits) << (x & 63);
+            count += static_cast<size_t>(__builtin_popcount(bits));
+        }
+    }
+    return count + build_cube_tail(b00, b01, b10, b11, x, cells, cubes, active);
+}
+
+bool cpu_has_neon() {
+#if defined(__linux__) && defined(HWCAP_ASIMD)
+    return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#else
+    return true; // AArch64 要求必须实现 Advanced SIMD
+#endif
+}
+
+#endif // MC_HAVE_NEON_KERNEL
+
+CubeClassifyKernels select_kernels() {
+    const CubeClassifyKernels scalar = {"scalar", classify_below_scalar,
+                                        classify_below_int_scalar<uint8_t>, classify_below_int_scalar<int16_t>,
+                                        classify_below_int_scalar<uint16_t>, build_cube_row_scalar};
+    const char *forced = std::getenv("MC_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) return scalar;
+#if defined(MC_HAVE_AVX2_KERNEL)
+    if (cpu_has_avx2()) return {"avx2", classify_below_avx2, classify_below_u8_avx2, classify_below_i16_avx2,
+                                    classify_below_u16_avx2, build_cube_row_avx2};
+#endif
+#if defined(MC_HAVE_NEON_KERNEL)
+    if (cpu_has_neon()) return {"neon", classify_below_neon, classify_below_u8_neon, classify_below_i16_neon,
+                                    classify_below_u16_neon, build_cube_row_neon};
+#endif
+    return scalar;
+}
+
+} // namespace
+
+const CubeClassifyKernels &cube_classify_kernels() {
+    static const CubeClassifyKernels kernels = select_kernels();
+    return kernels;
+}
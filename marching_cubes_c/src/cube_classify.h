@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Row-wise cube classification kernels for marching cubes.
+// classifyBelow: mask[i] = (src[i] < isoBias) ? 1 : 0
+// classifyBelowU8/I16/U16: the same test on integer voxels against an integer
+//                threshold (mask[i] = src[i] < threshold), so masks and CT volumes
+//                are classified in their native width without widening to float.
+// buildCubeRow:  from the below-masks of rows (y,z) (y+1,z) (y,z+1) (y+1,z+1), each
+//                cells+1 long, writes cubes[x] for x in [0, cells) and sets bit x of
+//                active (cells/64 rounded up words) when the cell is neither fully below
+//                nor fully above the iso value. Returns the number of active cells.
+// The implementation is picked once at runtime from CPU features (AVX2 on x86-64,
+// NEON on aarch64, portable scalar otherwise); MC_SIMD=scalar forces the fallback.
+
+struct CubeClassifyKernels {
+    const char *name;
+    void (*classifyBelow)(const float *src, size_t n, float isoBias, uint8_t *mask);
+    void (*classifyBelowU8)(const uint8_t *src, size_t n, uint8_t threshold, uint8_t *mask);
+    void (*classifyBelowI16)(const int16_t *src, size_t n, int16_t threshold, uint8_t *mask);
+    void (*classifyBelowU16)(const uint16_t *src, size_t n, uint16_t threshold, uint8_t *mask);
+    size_t (*buildCubeRow)(const uint8_t *b00, const uint8_t *b01,
+                           const uint8_t *b10, const uint8_t *b11,
+                           size_t cells, uint8_t *cubes, uint64_t *active);
+};
+
+const CubeClassifyKernels &cube_classify_kernels();
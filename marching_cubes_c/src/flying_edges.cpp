@@ -0,0 +1,303 @@
+#include "mc_common.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Flying Edges (Schroeder, Maynard, Geveci 2015)：以边为中心的四遍提取。
+// 每条边只由所在体素行处理一次，顶点编号由各行计数的前缀和直接确定，
+// 不需要边→顶点的查找结构；所有遍均按 z 平面分给各线程，写入区间事先确定。
+
+namespace {
+
+// 一行体素（固定 y、z）的计数；xL/xR 为修剪区间：体素 [0, xL] 与 [xR, nx-1] 上取值恒定
+struct FERow {
+    uint32_t xCuts = 0, yCuts = 0, zCuts = 0, tris = 0;
+    int xL = 0, xR = 0;
+};
+
+// 若干行的公共修剪区间 [L, R]（体素下标）：区间外各行取值恒定且彼此一致，没有交点。
+// 返回 false 表示区间为空
+inline bool group_trim(const FERow *const rows[], const uint8_t *const masks[], int count, int nx, int &L, int &R) {
+    L = nx - 1;
+    R = 0;
+    for (int i = 0; i < count; ++i) {
+        L = std::min(L, rows[i]->xL);
+        R = std::max(R, rows[i]->xR);
+    }
+    for (int i = 1; i < count; ++i) {
+        if (masks[i][0] != masks[0][0]) L = 0;
+        if (masks[i][nx - 1] != masks[0][nx - 1]) R = nx - 1;
+    }
+    return L <= R;
+}
+
+// 把 z 平面 [0, count) 均分给各线程
+template <typename Fn>
+void for_each_plane(int count, int numThreads, Fn &&fn) {
+    const int workers = std::max(1, std::min(numThreads, count));
+    if (workers == 1) {
+        for (int z = 0; z < count; ++z) fn(z);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int t = 0; t < workers; ++t) {
+        const int begin = static_cast<int>(static_cast<int64_t>(count) * t / workers);
+        const int end = static_cast<int>(static_cast<int64_t>(count) * (t + 1) / workers);
+        pool.emplace_back([&fn, begin, end]() {
+            for (int z = begin; z < end; ++z) fn(z);
+        });
+    }
+    for (auto &th : pool) th.join();
+}
+
+template <typename Voxel>
+class FlyingEdges {
+public:
+    FlyingEdges(const Voxel *vol, int nx, int ny, int nz, float iso, int numThreads)
+        : vol_(vol), nx_(nx), ny_(ny), nz_(nz), iso_(iso), numThreads_(numThreads),
+          kernels_(cube_classify_kernels()), threshold_(iso - 1e-6f) {}
+
+    void run(std::vector<MCVertex> &V, std::vector<MCTriangle> &T, std::vector<MCNormal> *normals) {
+        const size_t rows = static_cast<size_t>(ny_) * nz_;
+        masks_.resize(rows * static_cast<size_t>(nx_));
+        rows_.assign(rows, FERow());
+
+        // 第一遍：逐行分类，统计 x 边交点并求修剪区间
+        for_each_plane(nz_, numThreads_, [&](int z) {
+            for (int y = 0; y < ny_; ++y) classify_row(y, z);
+        });
+
+        // 第二遍：在修剪区间内统计 y/z 边交点与单元三角形数
+        for_each_plane(nz_, numThreads_, [&](int z) {
+            std::vector<uint8_t> cubes(static_cast<size_t>(nx_));
+            std::vector<uint64_t> active(static_cast<size_t>(nx_) / 64 + 1);
+            for (int y = 0; y < ny_; ++y) count_row(y, z, cubes.data(), active.data());
+        });
+
+        // 第三遍：各行顶点（x、y、z 边依次排列）与三角形的前缀和
+        vertexOffset_.resize(rows + 1);
+        triangleOffset_.resize(rows + 1);
+        size_t vertices = 0, triangles = 0;
+        for (size_t r = 0; r < rows; ++r) {
+            vertexOffset_[r] = vertices;
+            triangleOffset_[r] = triangles;
+            vertices += static_cast<size_t>(rows_[r].xCuts) + rows_[r].yCuts + rows_[r].zCuts;
+            triangles += rows_[r].tris;
+        }
+        vertexOffset_[rows] = vertices;
+        triangleOffset_[rows] = triangles;
+        V.resize(vertices);
+        T.resize(triangles);
+        if (normals) normals->resize(vertices);
+
+        // 第四遍：各行写入自己的顶点与三角形区间
+        MCVertex *outV = V.data();
+        MCTriangle *outT = T.data();
+        MCNormal *outN = normals ? normals->data() : nullptr;
+        for_each_plane(nz_, numThreads_, [&](int z) {
+            std::vector<uint8_t> cubes(static_cast<size_t>(nx_));
+            std::vector<uint64_t> active(static_cast<size_t>(nx_) / 64 + 1);
+            for (int y = 0; y < ny_; ++y) {
+                generate_vertices(y, z, outV, outN);
+                if (y < ny_ - 1 && z < nz_ - 1) generate_triangles(y, z, cubes.data(), active.data(), outT);
+            }
+        });
+    }
+
+private:
+    size_t row_index(int y, int z) const { return static_cast<size_t>(z) * ny_ + y; }
+    const uint8_t *mask(size_t r) const { return masks_.data() + r * static_cast<size_t>(nx_); }
+    const Voxel *voxels(int y, int z) const {
+        return vol_ + (static_cast<size_t>(z) * ny_ + y) * static_cast<size_t>(nx_);
+    }
+
+    void classify_row(int y, int z) {
+        const size_t r = row_index(y, z);
+        uint8_t *m = masks_.data() + r * static_cast<size_t>(nx_);
+        threshold_.classify(kernels_, voxels(y, z), static_cast<size_t>(nx_), m);
+        FERow &row = rows_[r];
+        row.xL = nx_ - 1;
+        row.xR = 0;
+        uint32_t cuts = 0;
+        for (int x = 0; x < nx_ - 1; ++x) cuts += m[x] != m[x + 1];
+        row.xCuts = cuts;
+        if (cuts == 0) return;
+        int first = 0, last = nx_ - 2;
+        while (m[first] == m[first + 1]) ++first;
+        while (m[last] == m[last + 1]) --last;
+        row.xL = first;
+        row.xR = last + 1;
+    }
+
+    // 行 r 与 r2 之间（y 或 z 方向）被切割的体素边数
+    uint32_t count_cross_cuts(size_t r, size_t r2) const {
+        const FERow *rows[2] = {&rows_[r], &rows_[r2]};
+        const uint8_t *masks[2] = {mask(r), mask(r2)};
+        int L, R;
+        if (!group_trim(rows, masks, 2, nx_, L, R)) return 0;
+        uint32_t cuts = 0;
+        for (int x = L; x <= R; ++x) cuts += masks[0][x] != masks[1][x];
+        return cuts;
+    }
+
+    // 单元行 (y, z) 的修剪区间内生成立方体索引与活跃位图，返回起始单元与单元数
+    bool classify_cells(int y, int z, uint8_t *cubes, uint64_t *active, int &L, int &cells) const {
+        const size_t r00 = row_index(y, z), r10 = r00 + 1, r01 = r00 + static_cast<size_t>(ny_), r11 = r01 + 1;
+        const FERow *rows[4] = {&rows_[r00], &rows_[r10], &rows_[r01], &rows_[r11]};
+        const uint8_t *masks[4] = {mask(r00), mask(r10), mask(r01), mask(r11)};
+        int R;
+        if (!group_trim(rows, masks, 4, nx_, L, R)) return false;
+        cells = R - L;
+        if (cells <= 0) return false;
+        kernels_.buildCubeRow(masks[0] + L, masks[1] + L, masks[2] + L, masks[3] + L,
+                              static_cast<size_t>(cells), cubes, active);
+        return true;
+    }
+
+    void count_row(int y, int z, uint8_t *cubes, uint64_t *active) {
+        const size_t r = row_index(y, z);
+        FERow &row = rows_[r];
+        if (y < ny_ - 1) row.yCuts = count_cross_cuts(r, r + 1);
+        if (z < nz_ - 1) row.zCuts = count_cross_cuts(r, r + static_cast<size_t>(ny_));
+        if (y == ny_ - 1 || z == nz_ - 1) return;
+
+        int L, cells;
+        if (!classify_cells(y, z, cubes, active, L, cells)) return;
+        const TriangleCountTable &triCount = triangle_counts();
+        uint32_t tris = 0;
+        for (int x = 0; x < cells; ++x) tris += triCount.count[cubes[x]];
+        row.tris = tris;
+    }
+
+    // reversed 时从 p2 向 p1 插值
+    void emit_vertex(uint32_t id, EdgeVertex p1, EdgeVertex p2, float val1, float val2, bool reversed,
+                     MCVertex *outV, MCNormal *outN) const {
+        if (reversed) {
+            std::swap(p1, p2);
+            std::swap(val1, val2);
+        }
+        const EdgeVertex v = vertex_lerp(iso_, p1, p2, val1, val2);
+        outV[id] = {v.x, v.y, v.z};
+        if (outN) outN[id] = edge_normal(vol_, nx_, ny_, nz_, iso_, p1, p2, val1, val2);
+    }
+
+    // 体素行 (y, z) 的顶点：先 x 边，再 y 边、z 边，各自按 x 递增。
+    // 插值方向与 marching-cubes 引擎中首个创建该边的单元一致（y>0 的 x 边与 x=0 的 y 边
+    // 由高端向低端插值），因此顶点坐标与法向逐位相同，只是编号顺序不同
+    void generate_vertices(int y, int z, MCVertex *outV, MCNormal *outN) const {
+        const size_t r = row_index(y, z);
+        const FERow &row = rows_[r];
+        uint32_t id = static_cast<uint32_t>(vertexOffset_[r]);
+        const uint8_t *m = mask(r);
+        const Voxel *v0 = voxels(y, z);
+        const float fy = static_cast<float>(y), fz = static_cast<float>(z);
+
+        for (int x = row.xL; x < row.xR; ++x) {
+            if (m[x] == m[x + 1]) continue;
+            emit_vertex(id++, {static_cast<float>(x), fy, fz}, {static_cast<float>(x + 1), fy, fz},
+                        static_cast<float>(v0[x]), static_cast<float>(v0[x + 1]), y > 0, outV, outN);
+        }
+
+        const auto cross_edges = [&](size_t r2, const Voxel *v1, float dy, float dz, uint32_t count) {
+            if (count == 0) return;
+            const FERow *rows[2] = {&row, &rows_[r2]};
+            const uint8_t *masks[2] = {m, mask(r2)};
+            int L, R;
+            group_trim(rows, masks, 2, nx_, L, R);
+            for (int x = L; x <= R; ++x) {
+                if (masks[0][x] == masks[1][x]) continue;
+                const float fx = static_cast<float>(x);
+                emit_vertex(id++, {fx, fy, fz}, {fx, fy + dy, fz + dz},
+                            static_cast<float>(v0[x]), static_cast<float>(v1[x]), dy > 0.0f && x == 0, outV, outN);
+            }
+        };
+        if (y < ny_ - 1) cross_edges(r + 1, voxels(y + 1, z), 1.0f, 0.0f, row.yCuts);
+        if (z < nz_ - 1) cross_edges(r + static_cast<size_t>(ny_), voxels(y, z + 1), 0.0f, 1.0f, row.zCuts);
+    }
+
+    // 单元行 (y, z) 的三角形。沿 x 前进时累计 4 行 x 边、2 行 y 边、2 行 z 边已经过的交点数，
+    // 由各行的顶点起始编号直接得到 12 条边的顶点编号；修剪区间之前这些行没有交点
+    void generate_triangles(int y, int z, uint8_t *cubes, uint64_t *active, MCTriangle *outT) const {
+        int first, cells;
+        if (!classify_cells(y, z, cubes, active, first, cells)) return;
+        const size_t r00 = row_index(y, z), r10 = r00 + 1, r01 = r00 + static_cast<size_t>(ny_), r11 = r01 + 1;
+        const auto xBase = [&](size_t r) { return static_cast<uint32_t>(vertexOffset_[r]); };
+        const auto yBase = [&](size_t r) { return static_cast<uint32_t>(vertexOffset_[r] + rows_[r].xCuts); };
+        const auto zBase = [&](size_t r) {
+            return static_cast<uint32_t>(vertexOffset_[r] + rows_[r].xCuts + rows_[r].yCuts);
+        };
+        uint32_t x00 = xBase(r00), x10 = xBase(r10), x01 = xBase(r01), x11 = xBase(r11);
+        uint32_t y00 = yBase(r00), y01 = yBase(r01);
+        uint32_t z00 = zBase(r00), z10 = zBase(r10);
+        size_t next = triangleOffset_[r00];
+
+        for_each_active_cell(active, (static_cast<size_t>(cells) + 63) / 64, [&](int cell) {
+            const int cubeindex = cubes[cell];
+            const int edges = edgeTable[cubeindex];
+
+            // 物理边编号与 edgeTable 位一致（见 marching_cubes.cpp 的 extract_layer）
+            uint32_t vertIndices[12];
+            vertIndices[0] = x00;
+            vertIndices[2] = x10;
+            vertIndices[4] = x01;
+            vertIndices[6] = x11;
+            vertIndices[3] = y00;
+            vertIndices[1] = y00 + ((edges >> 3) & 1);
+            vertIndices[7] = y01;
+            vertIndices[5] = y01 + ((edges >> 7) & 1);
+            vertIndices[8] = z00;
+            vertIndices[9] = z00 + ((edges >> 8) & 1);
+            vertIndices[11] = z10;
+            vertIndices[10] = z10 + ((edges >> 11) & 1);
+
+            const int *tri = triTable[cubeindex];
+            for (int i = 0; i + 2 < 16 && tri[i] != -1 && tri[i + 1] != -1 && tri[i + 2] != -1; i += 3) {
+                outT[next++] = {vertIndices[edge_index_map[tri[i]]], vertIndices[edge_index_map[tri[i + 1]]],
+                                vertIndices[edge_index_map[tri[i + 2]]]};
+            }
+
+            // 越过本单元左侧（体素 x）的边；右侧的边属于下一个单元的左侧
+            x00 += edges & 1;
+            x10 += (edges >> 2) & 1;
+            x01 += (edges >> 4) & 1;
+            x11 += (edges >> 6) & 1;
+            y00 += (edges >> 3) & 1;
+            y01 += (edges >> 7) & 1;
+            z00 += (edges >> 8) & 1;
+            z10 += (edges >> 11) & 1;
+        });
+    }
+
+    const Voxel *vol_;
+    int nx_, ny_, nz_;
+    float iso_;
+    int numThreads_;
+    const CubeClassifyKernels &kernels_;
+    VoxelThreshold<Voxel> threshold_;
+    std::vector<uint8_t> masks_;            // 各体素行的 below 掩码，行序 (z, y)
+    std::vector<FERow> rows_;
+    std::vector<size_t> vertexOffset_, triangleOffset_;
+};
+
+} // namespace
+
+template <typename Voxel>
+void flying_edges(const Voxel *vol, int nx, int ny, int nz, float iso,
+                  std::vector<MCVertex> &V, std::vector<MCTriangle> &T, const MCOptions &options) {
+    V.clear(); T.clear();
+    if (options.normals) options.normals->clear();
+    if (nx < 2 || ny < 2 || nz < 2) return;
+    FlyingEdges<Voxel> engine(vol, nx, ny, nz, iso, options.numThreads);
+    engine.run(V, T, options.normals);
+}
+
+template void flying_edges<float>(const float *, int, int, int, float,
+                                  std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void flying_edges<uint8_t>(const uint8_t *, int, int, int, float,
+                                    std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void flying_edges<int16_t>(const int16_t *, int, int, int, float,
+                                    std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void flying_edges<uint16_t>(const uint16_t *, int, int, int, float,
+                                     std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
@@ -1,32 +1,261 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cstdlib>
+#include <thread>
+#include <type_traits>
 
 #include "npy_reader.h"
 #include "marching_cubes.h"
 #include "vtk_writer.h"
+#include "mesh_writers.h"
+#include "npy_writer.h"
+#include "mesh_decimate.h"
+#include "mesh_smooth.h"
+#include "volume_pyramid.h"
+#include "span_index.h"
+#include "multi_label.h"
 
 static void print_usage() {
     std::cout << "用法:\n"
-              << "  marching_cubes_c --input /path/vol.npy --iso 0.5 --vtk out.vtk\n\n"
+              << "  marching_cubes_c --input /path/vol.npy --iso 0.5 --vtk out.vtk [--threads N] [--skip-empty] [--span-index] [--stream]\n"
+              << "                   [--engine marching-cubes|flying-edges|surface-nets] [--mask] [--labels <L1,L2,...|all>]\n"
+              << "                   [--normals] [--smooth <iterations>] [--decimate <ratio|count>] [--lod N]\n"
+              << "                   [--format vtk|vtk-binary|vtp|ply|stl|glb|npy|npz]\n\n"
               << "参数:\n"
               << "  --input <path>  输入NPY文件，形状(1,D,H,W)\n"
-              << "  --iso <value>   等值（浮点数）\n"
-              << "  --vtk <path>    输出VTK legacy PolyData文件（必选）\n";
+              << "  --iso <value>   等值（浮点数），可重复给出多次，每个等值输出一个网格\n"
+              << "  --vtk <path>    输出网格文件（必选）\n"
+              << "  --format <fmt>  输出格式：vtk（ASCII legacy，默认）、vtk-binary（大端二进制legacy）、vtp（VTK XML appended raw）、\n"
+              << "                  ply（二进制小端PLY）、stl（二进制STL）、glb（glTF二进制）、\n"
+              << "                  npy（<stem>_verts.npy与<stem>_tris.npy两个数组）、npz（未压缩NPZ，含verts与tris）\n"
+              << "  --threads <N>   按z-slab并行提取的线程数，0为自动（默认1），输出与线程数无关\n"
+              << "  --engine <e>    提取算法：marching-cubes（默认）、flying-edges（以边为中心的四遍算法，曲面相同、顶点编号不同）\n"
+              << "                  或 surface-nets（每个活跃单元一个顶点、每条切割边一个四边形，三角形更规整；\n"
+              << "                  vtk/vtk-binary/vtp/ply 且不平滑、不简化时直接输出四边形，其余格式剖分为三角形）\n"
+              << "  --mask          二值掩码模式：按等值压成每体素1位，64个单元一组分类，顶点取边中点（不插值）\n"
+              << "  --labels <v>    标签体数据（u1/i2/u2）：一次扫描为每个标签输出一个网格<stem>_label<L>，v为逗号分隔的标签或all（除0外全部）\n"
+              << "  --skip-empty    构建8³ brick最值索引，跳过不含等值面的区域（稀疏掩码加速）\n"
+              << "  --span-index    使用/生成<input>.mcidx跨度空间索引，多个等值时无需重新扫描体数据\n"
+              << "  --normals       输出顶点法向（由体数据梯度在提取时插值得到）；stl 仍使用面法向\n"
+              << "  --smooth <N>    Taubin λ/μ 平滑 N 次迭代（去除二值掩码的台阶），在简化之前执行\n"
+              << "  --decimate <v>  二次误差边折叠简化：v<=1 为保留的三角形比例，否则为目标三角形数\n"
+              << "  --lod <N>       输出N层细节：原分辨率及逐级2倍下采样（最值金字塔）的N-1层，写为<stem>_lod<k>，粗层先写\n"
+              << "  --stream        流式提取：每次只读入两个z平面，网格边提取边写出（体数据大于内存时使用）\n";
+}
+
+// 拆分扩展名：out.vtk -> ("out", ".vtk")；目录名中的点不算扩展名
+static void split_extension(const std::string &path, std::string &stem, std::string &ext) {
+    const size_t slash = path.find_last_of("/\\");
+    const size_t dot = path.find_last_of('.');
+    const bool hasExt = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    stem = hasExt ? path.substr(0, dot) : path;
+    ext = hasExt ? path.substr(dot) : std::string();
+}
+
+// 多个等值时在扩展名前追加等值：out.vtk -> out_iso300.vtk
+static std::string output_path_for_iso(const std::string &path, const std::string &isoText) {
+    std::string stem, ext;
+    split_extension(path, stem, ext);
+    return stem + "_iso" + isoText + ext;
+}
+
+// NPY输出拆成两个数组文件：out.npy -> out_verts.npy, out_tris.npy
+static std::string npy_member_path(const std::string &path, const std::string &member) {
+    std::string stem, ext;
+    split_extension(path, stem, ext);
+    return stem + "_" + member + ".npy";
+}
+
+// LOD 输出在扩展名前追加层号：out.vtk -> out_lod0.vtk（0 为原分辨率）
+static std::string lod_path(const std::string &path, int level) {
+    std::string stem, ext;
+    split_extension(path, stem, ext);
+    return stem + "_lod" + std::to_string(level) + ext;
+}
+
+// 标签输出在扩展名前追加标签：out.vtk -> out_label3.vtk
+static std::string label_path(const std::string &path, int label) {
+    std::string stem, ext;
+    split_extension(path, stem, ext);
+    return stem + "_label" + std::to_string(label) + ext;
+}
+
+// 解析 --labels：逗号分隔的整数，或 all（返回空列表）
+static bool parse_labels(const std::string &text, std::vector<int> &labels) {
+    labels.clear();
+    if (text == "all") return true;
+    size_t start = 0;
+    while (start <= text.size()) {
+        const size_t comma = std::min(text.find(',', start), text.size());
+        const std::string item = text.substr(start, comma - start);
+        size_t used = 0;
+        try { labels.push_back(std::stoi(item, &used)); } catch (const std::exception &) { return false; }
+        if (used != item.size()) return false;
+        start = comma + 1;
+    }
+    return !labels.empty();
+}
+
+enum class OutputFormat { Vtk, VtkBinary, Vtp, Ply, Stl, Glb, Npy, Npz };
+
+static bool parse_output_format(const std::string &name, OutputFormat &format) {
+    if (name == "vtk") format = OutputFormat::Vtk;
+    else if (name == "vtk-binary") format = OutputFormat::VtkBinary;
+    else if (name == "vtp") format = OutputFormat::Vtp;
+    else if (name == "ply") format = OutputFormat::Ply;
+    else if (name == "stl") format = OutputFormat::Stl;
+    else if (name == "glb") format = OutputFormat::Glb;
+    else if (name == "npy") format = OutputFormat::Npy;
+    else if (name == "npz") format = OutputFormat::Npz;
+    else return false;
+    return true;
+}
+
+static bool write_mesh(const std::string &path, OutputFormat format, const std::vector<MCVertex> &verts,
+                       const std::vector<MCTriangle> &tris, const std::vector<MCNormal> *normals,
+                       int threads, std::string &err) {
+    switch (format) {
+        case OutputFormat::VtkBinary: return write_vtk_legacy_binary(path, verts, tris, err, threads, normals);
+        case OutputFormat::Vtp: return write_vtp_polydata(path, verts, tris, err, threads, normals);
+        case OutputFormat::Ply: return write_ply_binary(path, verts, tris, err, threads, normals);
+        case OutputFormat::Stl: return write_stl_binary(path, verts, tris, err, threads);
+        case OutputFormat::Glb: return write_glb(path, verts, tris, err, normals);
+        case OutputFormat::Npy:
+            return write_mesh_npy(npy_member_path(path, "verts"), npy_member_path(path, "tris"), verts, tris, err) &&
+                   (!normals || write_normals_npy(npy_member_path(path, "normals"), *normals, err));
+        case OutputFormat::Npz: return write_mesh_npz(path, verts, tris, err, normals);
+        case OutputFormat::Vtk: break;
+    }
+    return write_vtk_legacy_polydata(path, verts, tris, err, threads, normals);
+}
+
+// 四边形网格只写入支持多边形单元的格式（见 keeps_quads）
+static bool write_quad_mesh(const std::string &path, OutputFormat format, const std::vector<MCVertex> &verts,
+                            const std::vector<MCQuad> &quads, const std::vector<MCNormal> *normals,
+                            int threads, std::string &err) {
+    switch (format) {
+        case OutputFormat::VtkBinary: return write_vtk_legacy_binary(path, verts, quads, err, threads, normals);
+        case OutputFormat::Vtp: return write_vtp_polydata(path, verts, quads, err, threads, normals);
+        case OutputFormat::Ply: return write_ply_binary(path, verts, quads, err, threads, normals);
+        default: break;
+    }
+    return write_vtk_legacy_polydata(path, verts, quads, err, threads, normals);
+}
+
+static bool keeps_quads(OutputFormat format) {
+    return format == OutputFormat::Vtk || format == OutputFormat::VtkBinary || format == OutputFormat::Vtp ||
+           format == OutputFormat::Ply;
+}
+
+// 校验形状(1,D,H,W)并取出体数据尺寸
+static bool volume_dims(const std::vector<size_t> &shape, int &nx, int &ny, int &nz) {
+    if (shape.size() != 4 || shape[0] != 1) {
+        std::cerr << "期望形状为(1,D,H,W)，实际: ";
+        for (size_t i=0;i<shape.size();++i) std::cerr << (i?",":"(") << shape[i];
+        std::cerr << ")\n";
+        return false;
+    }
+    nz = static_cast<int>(shape[1]);
+    ny = static_cast<int>(shape[2]);
+    nx = static_cast<int>(shape[3]);
+    return true;
+}
+
+// 流式模式：逐平面读取NPY，每个等值重新扫描一遍文件，网格经 VtkStreamWriter 边提取边写出
+static int run_streaming(const std::string &inputPath, const std::vector<std::string> &isoArgs,
+                         const std::vector<float> &isos, const std::string &outVTK) {
+    NpyStreamReader reader; std::string err;
+    if (!reader.open(inputPath, err)) { std::cerr << "读取NPY失败: " << err << "\n"; return 1; }
+    int nx = 0, ny = 0, nz = 0;
+    if (!volume_dims(reader.shape(), nx, ny, nz)) return 1;
+    const size_t plane = static_cast<size_t>(nx) * ny;
+
+    std::vector<int32_t> raw; // int32 没有原生内核，逐平面转换为 float
+    const auto extract = [&](auto tag, float iso, VtkStreamWriter &writer) -> bool {
+        using T = decltype(tag);
+        const MCPlaneReader<T> readPlane = [&](int z, T *dst, std::string &e) {
+            if constexpr (std::is_same_v<T, float>) {
+                if (reader.dtype() == NpyDType::I4) {
+                    raw.resize(plane);
+                    if (!reader.read(static_cast<size_t>(z) * plane, plane, raw.data(), e)) return false;
+                    std::transform(raw.begin(), raw.end(), dst, [](int32_t v) { return static_cast<float>(v); });
+                    return true;
+                }
+            }
+            return reader.read(static_cast<size_t>(z) * plane, plane, dst, e);
+        };
+        return marching_cubes_streaming(readPlane, nx, ny, nz, iso, writer, err);
+    };
+
+    for (size_t k = 0; k < isos.size(); ++k) {
+        const std::string outPath = isos.size() == 1 ? outVTK : output_path_for_iso(outVTK, isoArgs[k]);
+        VtkStreamWriter writer;
+        if (!writer.open(outPath, err)) { std::cerr << "写VTK失败: " << err << "\n"; return 1; }
+        bool ok = false;
+        switch (reader.dtype()) {
+            case NpyDType::U1: ok = extract(uint8_t(), isos[k], writer); break;
+            case NpyDType::I2: ok = extract(int16_t(), isos[k], writer); break;
+            case NpyDType::U2: ok = extract(uint16_t(), isos[k], writer); break;
+            case NpyDType::F4: case NpyDType::I4: ok = extract(float(), isos[k], writer); break;
+        }
+        if (!ok) { std::cerr << "流式提取失败: " << err << "\n"; return 1; }
+        if (!writer.finish(err)) { std::cerr << "写VTK失败: " << err << "\n"; return 1; }
+
+        if (isos.size() > 1) std::cout << outPath << ": ";
+        std::cout << "完成。顶点: " << writer.vertex_count() << ", 三角形: " << writer.triangle_count() << "\n";
+    }
+    return 0;
 }
 
 int main(int argc, char** argv) {
     std::string inputPath;
     std::string outVTK;
-    float iso = 0.5f;
+    std::vector<std::string> isoArgs;
     bool printStats = false;
+    int threads = 1;
+    bool skipEmpty = false;
+    bool useSpanIndex = false;
+    bool streaming = false;
+    bool withNormals = false;
+    bool binaryMask = false;
+    bool labelMode = false;
+    std::vector<int> labels;  // 空表示全部非0标签
+    int smoothIterations = 0;
+    MCEngine engine = MCEngine::MarchingCubes;
+    int lodLevels = 0;       // 0 表示不输出 LOD；否则为层数（含原分辨率）
+    double decimate = 0.0;   // 0 表示不简化；<= 1 为比例，否则为三角形数
+    OutputFormat format = OutputFormat::Vtk;
 
     for (int i=1; i<argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--input" && i+1 < argc) { inputPath = argv[++i]; }
-        else if (arg == "--iso" && i+1 < argc) { iso = std::stof(argv[++i]); }
+        else if (arg == "--iso" && i+1 < argc) { isoArgs.push_back(argv[++i]); }
         else if (arg == "--vtk" && i+1 < argc) { outVTK = argv[++i]; }
+        else if (arg == "--threads" && i+1 < argc) { threads = std::stoi(argv[++i]); }
+        else if (arg == "--skip-empty") { skipEmpty = true; }
+        else if (arg == "--span-index") { useSpanIndex = true; }
+        else if (arg == "--stream") { streaming = true; }
+        else if (arg == "--normals") { withNormals = true; }
+        else if (arg == "--mask") { binaryMask = true; }
+        else if (arg == "--labels" && i+1 < argc) {
+            labelMode = true;
+            if (!parse_labels(argv[++i], labels)) { std::cerr << "无效的标签列表: " << argv[i] << "\n"; return 1; }
+        }
+        else if (arg == "--engine" && i+1 < argc) {
+            const std::string name = argv[++i];
+            if (name == "marching-cubes") engine = MCEngine::MarchingCubes;
+            else if (name == "flying-edges") engine = MCEngine::FlyingEdges;
+            else if (name == "surface-nets") engine = MCEngine::SurfaceNets;
+            else { std::cerr << "未知提取算法: " << name << "\n"; return 1; }
+        }
+        else if (arg == "--lod" && i+1 < argc) { lodLevels = std::stoi(argv[++i]); }
+        else if (arg == "--smooth" && i+1 < argc) { smoothIterations = std::stoi(argv[++i]); }
+        else if (arg == "--decimate" && i+1 < argc) { decimate = std::stod(argv[++i]); }
+        else if (arg == "--format" && i+1 < argc) {
+            if (!parse_output_format(argv[++i], format)) { std::cerr << "未知输出格式: " << argv[i] << "\n"; return 1; }
+        }
         else if (arg == "--stats") { printStats = true; }
         else if (arg == "-h" || arg == "--help") { print_usage(); return 0; }
         else { std::cerr << "未知参数: " << arg << "\n"; print_usage(); return 1; }
@@ -34,45 +263,240 @@ int main(int argc, char** argv) {
 
     if (inputPath.empty()) { std::cerr << "必须提供--input\n"; print_usage(); return 1; }
     if (outVTK.empty()) { std::cerr << "必须提供--vtk\n"; print_usage(); return 1; }
+    if (threads < 0) { std::cerr << "--threads 不能为负数\n"; return 1; }
+    if (lodLevels < 0) { std::cerr << "--lod 不能为负数\n"; return 1; }
+    if (smoothIterations < 0) { std::cerr << "--smooth 不能为负数\n"; return 1; }
+    if (decimate < 0.0) { std::cerr << "--decimate 不能为负数\n"; return 1; }
+    if (binaryMask && engine != MCEngine::MarchingCubes) { std::cerr << "--mask 只支持 marching-cubes 算法\n"; return 1; }
+    // 位压缩路径不读取 brick 索引，构建它只浪费时间与内存
+    if (binaryMask && (skipEmpty || useSpanIndex)) {
+        std::cerr << "--mask 不能与 --skip-empty/--span-index 同时使用\n"; return 1;
+    }
+    if (labelMode && (!isoArgs.empty() || lodLevels > 0 || streaming || binaryMask || skipEmpty || useSpanIndex ||
+                      engine != MCEngine::MarchingCubes)) {
+        std::cerr << "--labels 不能与 --iso/--lod/--stream/--mask/--skip-empty/--span-index/--engine 同时使用\n"; return 1;
+    }
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (isoArgs.empty()) isoArgs.push_back("0.5");
+    std::vector<float> isos;
+    for (const auto &text : isoArgs) isos.push_back(std::stof(text));
 
-    // Load npy to float
-    std::vector<size_t> shape; std::vector<float> vol; std::string err;
-    if (!load_npy_to_float(inputPath, shape, vol, err)) {
-        std::cerr << "读取NPY失败: " << err << "\n"; return 1;
+    if (streaming) {
+        if (skipEmpty || useSpanIndex) { std::cerr << "--stream 不能与 --skip-empty/--span-index 同时使用\n"; return 1; }
+        if (format != OutputFormat::Vtk) { std::cerr << "--stream 目前只支持 --format vtk\n"; return 1; }
+        if (withNormals || smoothIterations > 0 || decimate > 0.0 || lodLevels > 0) {
+            std::cerr << "--stream 不支持 --normals/--smooth/--decimate/--lod\n"; return 1;
+        }
+        if (engine != MCEngine::MarchingCubes) { std::cerr << "--stream 只支持 marching-cubes 算法\n"; return 1; }
+        if (binaryMask) { std::cerr << "--stream 不支持 --mask\n"; return 1; }
+        return run_streaming(inputPath, isoArgs, isos, outVTK);
     }
 
-    if (shape.size() != 4 || shape[0] != 1) {
-        std::cerr << "期望形状为(1,D,H,W)，实际: ";
-        for (size_t i=0;i<shape.size();++i) std::cerr << (i?",":"(") << shape[i];
-        std::cerr << ")\n";
-        return 1;
+    // 映射NPY：小端C顺序数据直接使用映射区
+    NpyView npy; std::string err;
+    if (!npy.open(inputPath, err)) {
+        std::cerr << "读取NPY失败: " << err << "\n"; return 1;
     }
-    int nz = static_cast<int>(shape[1]);
-    int ny = static_cast<int>(shape[2]);
-    int nx = static_cast<int>(shape[3]);
+    int nx = 0, ny = 0, nz = 0;
+    if (!volume_dims(npy.shape(), nx, ny, nz)) return 1;
 
     size_t expected = static_cast<size_t>(nx)*ny*nz;
-    if (vol.size() != expected) {
+    if (npy.count() != expected) {
         std::cerr << "数据大小与shape不一致\n"; return 1;
     }
 
-    if (printStats) {
-        double mn = vol[0], mx = vol[0], sum = 0.0;
-        for (size_t i=0;i<vol.size();++i) { if (vol[i]<mn) mn=vol[i]; if (vol[i]>mx) mx=vol[i]; sum += vol[i]; }
-        double mean = sum / static_cast<double>(vol.size());
-        std::cout << "数据统计: min=" << mn << ", max=" << mx << ", mean=" << mean << "\n";
-    }
+    // 按NPY dtype分派到对应体素类型的提取实现，整数体数据不再转换为float
+    const auto run = [&](const auto *vol) -> int {
+        if (printStats) {
+            double mn = vol[0], mx = vol[0], sum = 0.0;
+            for (size_t i=0;i<expected;++i) { if (vol[i]<mn) mn=vol[i]; if (vol[i]>mx) mx=vol[i]; sum += vol[i]; }
+            double mean = sum / static_cast<double>(expected);
+            std::cout << "数据统计: min=" << mn << ", max=" << mx << ", mean=" << mean << "\n";
+        }
 
-    // Marching Cubes
-    std::vector<MCVertex> verts; std::vector<MCTriangle> tris;
-    marching_cubes(vol.data(), nx, ny, nz, iso, verts, tris);
+        // LOD 金字塔与等值无关，只构建一次；需要扫描体数据构建最值索引时，2x 层在同一遍中生成
+        using Voxel = std::remove_const_t<std::remove_pointer_t<decltype(vol)>>;
+        std::vector<PyramidLevel<Voxel>> pyramid;
+        const bool withPyramid = lodLevels > 1 && can_downsample(nx, ny, nz);
+        const auto build_block_index = [&](MinMaxBlockIndex &index) {
+            if (withPyramid) pyramid.emplace_back();
+            index.build(vol, nx, ny, nz, threads, withPyramid ? &pyramid.back() : nullptr);
+        };
 
-    if (!write_vtk_legacy_polydata(outVTK, verts, tris, err)) {
-        std::cerr << "写VTK失败: " << err << "\n"; return 1;
-    }
+        // 空区域跳过：最值索引只扫描一次体数据；跨度空间索引可从磁盘复用
+        MinMaxBlockIndex blockIndex;
+        SpanSpaceIndex spanIndex;
+        if (useSpanIndex) {
+            const std::string indexPath = span_index_path(inputPath);
+            std::string indexErr;
+            if (spanIndex.load(indexPath, inputPath, nx, ny, nz, indexErr)) {
+                if (printStats) std::cout << "已加载span索引: " << indexPath << "\n";
+            } else {
+                build_block_index(blockIndex);
+                spanIndex.build(blockIndex, nx, ny, nz);
+                if (!spanIndex.save(indexPath, inputPath, indexErr)) {
+                    std::cerr << "保存span索引失败: " << indexErr << "\n";
+                } else if (printStats) {
+                    std::cout << "已生成span索引: " << indexPath << "\n";
+                }
+            }
+        } else if (skipEmpty) {
+            build_block_index(blockIndex);
+        }
+        if (withPyramid) {
+            if (pyramid.empty()) build_volume_pyramid(vol, nx, ny, nz, lodLevels - 1, threads, pyramid);
+            else extend_volume_pyramid(lodLevels - 2, threads, pyramid);
+        }
+        // 要求跳过空区域时粗层同样只提取活跃 brick；各层的索引由层内最值构建，与等值无关
+        std::vector<MinMaxBlockIndex> levelIndices(useSpanIndex || skipEmpty ? pyramid.size() : 0);
+        for (size_t l = 0; l < levelIndices.size(); ++l) levelIndices[l].build(pyramid[l], threads);
+        std::vector<Voxel> levelField;
 
-    std::cout << "完成。顶点: " << verts.size() << ", 三角形: " << tris.size() << "\n";
-    return 0;
-}
+        // Surface Nets 的四边形在不平滑、不简化且格式支持多边形单元时原样写出，否则剖分为三角形
+        const bool withQuads = engine == MCEngine::SurfaceNets && smoothIterations == 0 && decimate <= 0.0 &&
+                               keeps_quads(format);
+
+        // 网格后处理（平滑、简化）并写出；quads 非空时直接写出四边形
+        const auto finish_mesh = [&](const std::string &outPath, std::vector<MCVertex> &verts,
+                                     std::vector<MCTriangle> &tris, const std::vector<MCQuad> *quads,
+                                     std::vector<MCNormal> *normals) -> bool {
+            if (quads) {
+                if (!write_quad_mesh(outPath, format, verts, *quads, normals, threads, err)) {
+                    std::cerr << "写VTK失败: " << err << "\n"; return false;
+                }
+                if (isos.size() > 1 || lodLevels > 0 || labelMode) std::cout << outPath << ": ";
+                std::cout << "完成。顶点: " << verts.size() << ", 四边形: " << quads->size() << "\n";
+                return true;
+            }
+
+            if (smoothIterations > 0) {
+                MCSmoothOptions smoothing;
+                smoothing.iterations = smoothIterations;
+                smoothing.numThreads = threads;
+                smoothing.normals = normals;
+                smooth_mesh(verts, tris, smoothing);
+            }
+
+            if (decimate > 0.0) {
+                MCDecimateOptions simplify;
+                simplify.targetTriangles = decimate <= 1.0
+                    ? static_cast<size_t>(static_cast<double>(tris.size()) * decimate)
+                    : static_cast<size_t>(decimate);
+                simplify.numThreads = threads;
+                simplify.normals = normals;
+                const size_t before = tris.size();
+                decimate_mesh(verts, tris, simplify);
+                if (printStats) std::cout << "简化: 三角形 " << before << " -> " << tris.size() << "\n";
+            }
+
+            if (!write_mesh(outPath, format, verts, tris, normals, threads, err)) {
+                std::cerr << "写VTK失败: " << err << "\n"; return false;
+            }
+
+            if (isos.size() > 1 || lodLevels > 0 || labelMode) std::cout << outPath << ": ";
+            std::cout << "完成。顶点: " << verts.size() << ", 三角形: " << tris.size() << "\n";
+            return true;
+        };
+
+        // 多标签：一次扫描提取全部标签，每个标签单独后处理并写出
+        if (labelMode) {
+            if constexpr (std::is_integral_v<Voxel>) {
+                MCLabelOptions labelOptions;
+                labelOptions.labels = labels;
+                labelOptions.numThreads = threads;
+                labelOptions.normals = withNormals;
+                std::vector<MCLabelSurface> surfaces;
+                marching_cubes_labels(vol, nx, ny, nz, labelOptions, surfaces);
+                for (auto &surface : surfaces) {
+                    // 体数据中不存在（或不形成曲面）的标签不写出空网格
+                    if (surface.triangles.empty()) {
+                        std::cerr << "警告: 标签 " << surface.label << " 没有曲面（体数据中不存在），跳过\n";
+                        continue;
+                    }
+                    if (!finish_mesh(label_path(outVTK, surface.label), surface.vertices, surface.triangles, nullptr,
+                                     withNormals ? &surface.normals : nullptr)) return 1;
+                }
+                return 0;
+            } else {
+                std::cerr << "--labels 需要整数标签体数据（u1/i2/u2）\n"; return 1;
+            }
+        }
 
+        // Marching Cubes：一次加载，逐个等值提取并输出
+        for (size_t k = 0; k < isos.size(); ++k) {
+            const float iso = isos[k];
+            const std::string outPath = isos.size() == 1 ? outVTK : output_path_for_iso(outVTK, isoArgs[k]);
 
+            // 粗层先写出，查看器可以先显示预览
+            for (size_t l = pyramid.size(); l-- > 0;) {
+                const PyramidLevel<Voxel> &level = pyramid[l];
+                pyramid_level_field(level, iso, levelField);
+                std::vector<MCVertex> verts; std::vector<MCTriangle> tris; std::vector<MCQuad> quads;
+                std::vector<MCNormal> normals;
+                MCOptions options;
+                options.numThreads = threads;
+                options.engine = engine;
+                options.binaryMask = binaryMask;
+                if (withNormals) options.normals = &normals;
+                if (withQuads) options.quads = &quads;
+                ActiveBricks levelBricks;
+                if (!levelIndices.empty()) {
+                    levelIndices[l].find_active(iso, levelBricks);
+                    options.activeBricks = &levelBricks;
+                }
+                marching_cubes(levelField.data(), level.nx, level.ny, level.nz, iso, verts, tris, options);
+
+                // 粗体素 i 覆盖细体素 [s*i, s*i+s-1]，取其中心映射回原体素坐标
+                const float s = static_cast<float>(level.scale), offset = 0.5f * (s - 1.0f);
+                const float maxX = static_cast<float>(nx - 1), maxY = static_cast<float>(ny - 1),
+                            maxZ = static_cast<float>(nz - 1);
+                for (auto &v : verts) {
+                    v = {std::min(v.x * s + offset, maxX), std::min(v.y * s + offset, maxY),
+                         std::min(v.z * s + offset, maxZ)};
+                }
+                if (!finish_mesh(lod_path(outPath, static_cast<int>(l) + 1), verts, tris, options.quads,
+                                 options.normals)) return 1;
+            }
+
+            std::vector<MCVertex> verts; std::vector<MCTriangle> tris; std::vector<MCQuad> quads;
+            std::vector<MCNormal> normals;
+            MCOptions options;
+            options.numThreads = threads;
+            options.engine = engine;
+            options.binaryMask = binaryMask;
+            if (withNormals) options.normals = &normals;
+            if (withQuads) options.quads = &quads;
+            ActiveBricks activeBricks;
+            if (useSpanIndex || skipEmpty) {
+                if (useSpanIndex) spanIndex.find_active(iso, activeBricks);
+                else blockIndex.find_active(iso, activeBricks);
+                options.activeBricks = &activeBricks;
+                if (printStats) {
+                    std::cout << "iso=" << isoArgs[k] << " 活跃brick: " << activeBricks.activeCount
+                              << " / " << activeBricks.active.size() << "\n";
+                }
+            }
+            marching_cubes(vol, nx, ny, nz, iso, verts, tris, options);
+            if (!finish_mesh(lodLevels > 0 ? lod_path(outPath, 0) : outPath, verts, tris, options.quads,
+                             options.normals)) return 1;
+        }
+        return 0;
+    };
+
+    switch (npy.dtype()) {
+        case NpyDType::F4: return run(npy.as<float>());
+        case NpyDType::U1: return run(npy.as<uint8_t>());
+        case NpyDType::I2: return run(npy.as<int16_t>());
+        case NpyDType::U2: return run(npy.as<uint16_t>());
+        case NpyDType::I4: break;
+    }
+
+    // int32 没有原生分类内核，转换为 float 后提取
+    std::vector<size_t> convertedShape;
+    std::vector<float> converted;
+    npy.close();
+    if (!load_npy_to_float(inputPath, convertedShape, converted, err)) {
+        std::cerr << "读取NPY失败: " << err << "\n"; return 1;
+    }
+    return run(converted.data());
+}
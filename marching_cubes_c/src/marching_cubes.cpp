@@ -1,14 +1,20 @@
 #include "marching_cubes.h"
+#include "mc_common.h"
+#include "bit_mask.h"
 
+#include <algorithm>
 #include <cmath>
-#include <unordered_map>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 // Marching Cubes case tables (edgeTable, triTable)
 // Source cross-checked with Paul Bourke's reference and the original paper tables:
 // http://paulbourke.net/geometry/polygonise/
 // Reference: Lorensen & Cline (1987) "Marching Cubes: A high resolution 3D surface construction algorithm"
 
-static const int edgeTable[256] = {
+const int edgeTable[256] = {
 0x0,  0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
 0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
 0x190, 0x99,  0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c,
@@ -43,7 +49,7 @@ static const int edgeTable[256] = {
 0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x0
 };
 
-static const int triTable[256][16] = {
+const int triTable[256][16] = {
 { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 }, /* 0 0 */
 { 0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 }, /* 1 1 */
 { 0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 }, /* 2 1 */
@@ -302,145 +308,555 @@ static const int triTable[256][16] = {
 { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 }  /* 255 0 */
 };
 
-struct EdgeVertex { float x, y, z; };
+namespace {
 
-static inline EdgeVertex vertex_lerp(float iso, const EdgeVertex &p1, const EdgeVertex &p2, float valp1, float valp2) {
-    const float EPS = 1e-6f;
-    const float diff = valp2 - valp1;
-    if (std::fabs(iso - valp1) < EPS) return p1;
-    if (std::fabs(iso - valp2) < EPS) return p2;
-    if (std::fabs(diff) < EPS) {
-        return { (p1.x + p2.x) * 0.5f, (p1.y + p2.y) * 0.5f, (p1.z + p2.z) * 0.5f };
+// 逐行分类器：维护平面 z / z+1 上第 y、y+1 行的 below 掩码（相邻行复用，不再对每个
+// 单元重复 8 次读取体素），由 SIMD 内核一次生成整行单元的立方体索引与活跃位图。
+// 给定 ActiveBricks 时只分类含活跃 brick 的 64 单元字，其余单元直接视为不活跃。
+template <typename T>
+class RowClassifier {
+public:
+    static_assert(64 % kBrickSize == 0, "a 64-cell word must hold whole bricks");
+    static constexpr int kBricksPerWord = 64 / kBrickSize;
+
+    RowClassifier(int nx, int ny, float isoBias, const ActiveBricks *bricks)
+        : nx_(static_cast<size_t>(nx)), plane_(static_cast<size_t>(nx) * static_cast<size_t>(ny)),
+          threshold_(isoBias), kernels_(cube_classify_kernels()), bricks_(bricks),
+          cubes_(nx_ - 1), active_((nx_ - 1 + 63) / 64), words_(active_.size(), 1) {
+        for (auto &m : masks_) m.resize(nx_);
+    }
+
+    // lower 指向平面 z，平面 z+1 紧随其后
+    void begin_layer(const T *lower, int z) {
+        z_ = z;
+        layer_ = lower;
+        prevRow_ = -2;
+    }
+
+    // 分类单元行 y（同一层内按 y 递增调用），返回活跃单元数
+    size_t classify_row(int y) {
+        if (bricks_ && (y % kBrickSize == 0 || prevRow_ < 0)) {
+            if (!select_words(y / kBrickSize, z_ / kBrickSize)) {
+                prevRow_ = -2;
+                return 0;
+            }
+            prevRow_ = -2; // 分类范围变化，行 y 的掩码需要重新计算
+        }
+        if (prevRow_ != y - 1) classify_masks(y, masks_[1].data(), masks_[3].data());
+        std::swap(masks_[0], masks_[1]);
+        std::swap(masks_[2], masks_[3]);
+        classify_masks(y + 1, masks_[1].data(), masks_[3].data());
+        prevRow_ = y;
+
+        const size_t cells = nx_ - 1;
+        if (!bricks_) {
+            return kernels_.buildCubeRow(masks_[0].data(), masks_[1].data(), masks_[2].data(), masks_[3].data(),
+                                         cells, cubes_.data(), active_.data());
+        }
+        size_t count = 0;
+        for (size_t w = 0; w < words_.size(); ++w) {
+            if (!words_[w]) { active_[w] = 0; continue; }
+            const size_t x0 = w * 64;
+            count += kernels_.buildCubeRow(masks_[0].data() + x0, masks_[1].data() + x0,
+                                           masks_[2].data() + x0, masks_[3].data() + x0,
+                                           std::min<size_t>(64, cells - x0), cubes_.data() + x0, active_.data() + w);
+        }
+        return count;
+    }
+
+    int cube(int x) const { return cubes_[static_cast<size_t>(x)]; }
+
+    // 单元的 8 个角点值：c00 为角点 0 在平面内的偏移，平面 z+1 紧随 lower 之后
+    template <typename Voxel>
+    void corner_values(const Voxel *lower, size_t c00, int, float val[8]) const {
+        const Voxel *upper = lower + plane_;
+        const size_t c10 = c00 + 1, c01 = c00 + nx_, c11 = c01 + 1;
+        val[0] = static_cast<float>(lower[c00]);
+        val[1] = static_cast<float>(lower[c10]);
+        val[2] = static_cast<float>(lower[c11]);
+        val[3] = static_cast<float>(lower[c01]);
+        val[4] = static_cast<float>(upper[c00]);
+        val[5] = static_cast<float>(upper[c10]);
+        val[6] = static_cast<float>(upper[c11]);
+        val[7] = static_cast<float>(upper[c01]);
+    }
+
+    // 按 x 递增遍历当前行的活跃单元，整字为 0 时一次跳过 64 个单元
+    template <typename Fn>
+    void for_each_active(Fn &&fn) const {
+        for_each_active_cell(active_.data(), active_.size(), fn);
+    }
+
+private:
+    // brick 行 (by, bz) 中含活跃 brick 的 64 单元字，返回是否存在
+    bool select_words(int by, int bz) {
+        bool any = false;
+        for (size_t w = 0; w < words_.size(); ++w) {
+            const int bxEnd = std::min(static_cast<int>(w + 1) * kBricksPerWord, bricks_->bricksX);
+            uint8_t hit = 0;
+            for (int bx = static_cast<int>(w) * kBricksPerWord; bx < bxEnd && !hit; ++bx) {
+                hit = bricks_->is_active(bx, by, bz) ? 1 : 0;
+            }
+            words_[w] = hit;
+            any = any || hit;
+        }
+        return any;
+    }
+
+    void classify_masks(int y, uint8_t *lo, uint8_t *hi) {
+        const T *row = layer_ + static_cast<size_t>(y) * nx_;
+        if (!bricks_) {
+            threshold_.classify(kernels_, row, nx_, lo);
+            threshold_.classify(kernels_, row + plane_, nx_, hi);
+            return;
+        }
+        // 每个字需要 65 个体素（含右侧共享体素）
+        for (size_t w = 0; w < words_.size(); ++w) {
+            if (!words_[w]) continue;
+            const size_t x0 = w * 64;
+            const size_t n = std::min<size_t>(65, nx_ - x0);
+            threshold_.classify(kernels_, row + x0, n, lo + x0);
+            threshold_.classify(kernels_, row + plane_ + x0, n, hi + x0);
+        }
+    }
+
+    const T *layer_ = nullptr;
+    size_t nx_, plane_;
+    VoxelThreshold<T> threshold_;
+    const CubeClassifyKernels &kernels_;
+    const ActiveBricks *bricks_;
+    int z_ = 0;
+    int prevRow_ = -2;
+    // 行掩码：0=(y,z) 1=(y+1,z) 2=(y,z+1) 3=(y+1,z+1)
+    std::vector<uint8_t> masks_[4];
+    std::vector<uint8_t> cubes_;
+    std::vector<uint64_t> active_;
+    std::vector<uint8_t> words_;
+};
+
+// 8 个字的 8x8 字节矩阵原地转置：之后 w[g] 的字节 k 为原 w[k] 的字节 g
+inline void transpose_bytes(uint64_t w[8]) {
+    for (int k = 0; k < 4; ++k) {
+        const uint64_t t = ((w[k] >> 32) ^ w[k + 4]) & 0x00000000FFFFFFFFULL;
+        w[k] ^= t << 32; w[k + 4] ^= t;
+    }
+    for (int k : {0, 1, 4, 5}) {
+        const uint64_t t = ((w[k] >> 16) ^ w[k + 2]) & 0x0000FFFF0000FFFFULL;
+        w[k] ^= t << 16; w[k + 2] ^= t;
+    }
+    for (int k : {0, 2, 4, 6}) {
+        const uint64_t t = ((w[k] >> 8) ^ w[k + 1]) & 0x00FF00FF00FF00FFULL;
+        w[k] ^= t << 8; w[k + 1] ^= t;
     }
-    const float mu = (iso - valp1) / diff;
-    return { p1.x + mu * (p2.x - p1.x), p1.y + mu * (p2.y - p1.y), p1.z + mu * (p2.z - p1.z) };
 }
 
-void marching_cubes(const float *vol, int nx, int ny, int nz, float iso, std::vector<MCVertex> &V, std::vector<MCTriangle> &T) {
-    // triTable 边索引 → edgeTable 位编号的映射（对调 10 与 11）
-    static const int edge_index_map[12] = {0,1,2,3,4,5,6,7,8,9,11,10};
-    V.clear(); T.clear();
-    V.reserve(1u * nx * ny * 3u); // rough
-    T.reserve(1u * nx * ny * 2u);
+// 8x8 位矩阵转置（Hacker's Delight 7-3）：字节 k 的位 i 移到字节 i 的位 k
+inline uint64_t transpose_bits(uint64_t x) {
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
 
-    // Edge-to-vertex mapping for proper vertex sharing
-    std::unordered_map<uint64_t, uint32_t> edge_to_vertex;
+// 掩码模式的逐行分类器，接口与 RowClassifier 相同，但只读取位打包的体数据：
+// 每次由 4 行的字移位得到 64 个单元的 8 个角点位，活跃位 = 角点位之或 & ~角点位之与，
+// 全 0 的字直接跳过；8 个角点字先按字节转置，每个含活跃单元的 8 单元组再做一次 8x8 位转置，一次得到 8 个立方体索引。
+// 角点值取 below ? 0 : 1，配合等值 0.5 插值，顶点恒为边的中点，不读体素值
+class PackedRowClassifier {
+public:
+    PackedRowClassifier(const BitMaskVolume &mask, int nx)
+        : mask_(mask), cells_(static_cast<size_t>(nx) - 1), words_(mask.words_per_row()),
+          cubes_(active_words() * 64), active_(active_words()) {}
 
-    const auto idx = [&](int x, int y, int z) -> size_t {
-        return static_cast<size_t>(z) * ny * nx + static_cast<size_t>(y) * nx + static_cast<size_t>(x);
-    };
+    template <typename Voxel>
+    void begin_layer(const Voxel *, int z) { z_ = z; }
 
-    // 使用两个体素角点的线性索引作为边键，避免位宽截断与碰撞
-    const auto get_edge_key = [&](int x1, int y1, int z1, int x2, int y2, int z2) -> uint64_t {
-        auto corner_id = [&](int x, int y, int z) -> uint64_t {
-            return static_cast<uint64_t>(z) * static_cast<uint64_t>(ny) * static_cast<uint64_t>(nx)
-                 + static_cast<uint64_t>(y) * static_cast<uint64_t>(nx)
-                 + static_cast<uint64_t>(x);
+    size_t classify_row(int y) {
+        const uint64_t *a = mask_.row(y, z_), *b = mask_.row(y + 1, z_);
+        const uint64_t *c = mask_.row(y, z_ + 1), *d = mask_.row(y + 1, z_ + 1);
+        // 右移一位并补入下一个字的最低位，得到体素 x+1 的位
+        const auto next = [this](const uint64_t *row, size_t w) {
+            return (row[w] >> 1) | (w + 1 < words_ ? row[w + 1] << 63 : 0);
         };
+        size_t count = 0;
+        for (size_t w = 0; w < active_.size(); ++w) {
+            uint64_t corner[8] = {a[w], next(a, w), next(b, w), b[w], c[w], next(c, w), next(d, w), d[w]};
+            uint64_t any = 0, all = ~uint64_t(0);
+            for (uint64_t bits : corner) { any |= bits; all &= bits; }
+            const size_t n = std::min<size_t>(64, cells_ - w * 64);
+            uint64_t active = any & ~all;
+            if (n < 64) active &= (uint64_t(1) << n) - 1;
+            active_[w] = active;
+            if (!active) continue;
+            count += static_cast<size_t>(__builtin_popcountll(active));
+            transpose_bytes(corner);    // corner[g] 的字节 k：角点 k 在单元 8g..8g+7 的位
+            for (int g = 0; g < 8; ++g) {
+                if (!((active >> (8 * g)) & 0xFF)) continue;
+                const uint64_t cubes = transpose_bits(corner[g]);
+                uint8_t *out = cubes_.data() + w * 64 + static_cast<size_t>(8 * g);
+                for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(cubes >> (8 * i));
+            }
+        }
+        return count;
+    }
 
-        uint64_t a = corner_id(x1, y1, z1);
-        uint64_t b = corner_id(x2, y2, z2);
-        if (a > b) std::swap(a, b);
-        return (a << 32) | b; // a、b 均假定在 32 位范围内
-    };
+    int cube(int x) const { return cubes_[static_cast<size_t>(x)]; }
 
-    // Helper function to get or create vertex for an edge
-    const auto get_edge_vertex = [&](int x1, int y1, int z1, int x2, int y2, int z2,
-                                   float val1, float val2, const EdgeVertex &p1, const EdgeVertex &p2) -> uint32_t {
-        uint64_t edge_key = get_edge_key(x1, y1, z1, x2, y2, z2);
+    template <typename Voxel>
+    void corner_values(const Voxel *, size_t, int cube, float val[8]) const {
+        for (int k = 0; k < 8; ++k) val[k] = (cube >> k) & 1 ? 0.0f : 1.0f;
+    }
+
+    template <typename Fn>
+    void for_each_active(Fn &&fn) const {
+        for_each_active_cell(active_.data(), active_.size(), fn);
+    }
 
-        auto it = edge_to_vertex.find(edge_key);
-        if (it != edge_to_vertex.end()) {
-            return it->second;
+private:
+    size_t active_words() const { return (cells_ + 63) / 64; }
+
+    const BitMaskVolume &mask_;
+    size_t cells_, words_;
+    int z_ = 0;
+    std::vector<uint8_t> cubes_;
+    std::vector<uint64_t> active_;
+};
+
+// 掩码模式下插值用的等值：角点值为 0/1 时 vertex_lerp 恰好给出边的中点
+constexpr float kMaskIso = 0.5f;
+
+// 单个 z-slab（单元层 [z0, z1)）的两遍提取状态
+struct SlabTask {
+    int z0 = 0, z1 = 0;
+    // 第一遍：slab 将新建的顶点数与三角形数
+    size_t vertexCount = 0, triangleCount = 0;
+    // 前缀和得到的全局写入偏移
+    size_t vertexOffset = 0, triangleOffset = 0;
+    // 引用前一个 slab 所建顶点的三角形角点：(三角形下标*3 + 角点, (平面偏移 << 1) | 轴)
+    std::vector<std::pair<size_t, uint64_t>> patches;
+    // 上平面 z1 的 x/y 边全局顶点编号，供下一个 slab 解析 patches
+    std::vector<uint32_t> xTop, yTop;
+};
+
+// 第一遍：只做分类，按 owned_edge_mask 统计本 slab 新建的顶点与三角形
+template <typename Rows, typename T>
+void count_slab(Rows &rows, const T *vol, int nx, int ny, SlabTask &task) {
+    const TriangleCountTable &triCount = triangle_counts();
+    const size_t plane = static_cast<size_t>(nx) * static_cast<size_t>(ny);
+    size_t vertices = 0, triangles = 0;
+    for (int z = task.z0; z < task.z1; ++z) {
+        // slab 首层且 z0>0 时下平面的边 (0..3) 属于前一个 slab
+        const int lowerMask = (z == task.z0 && task.z0 > 0) ? ~0xF : ~0;
+        rows.begin_layer(vol + static_cast<size_t>(z) * plane, z);
+        for (int y = 0; y < ny - 1; ++y) {
+            if (rows.classify_row(y) == 0) continue;
+            rows.for_each_active([&](int x) {
+                const int cubeindex = rows.cube(x);
+                const int edges = edgeTable[cubeindex] & owned_edge_mask(x, y, z) & lowerMask;
+                vertices += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(edges)));
+                triangles += triCount.count[cubeindex];
+            });
         }
+    }
+    task.vertexCount = vertices;
+    task.triangleCount = triangles;
+}
 
-        // Create new vertex
-        EdgeVertex new_vertex = vertex_lerp(iso, p1, p2, val1, val2);
-        uint32_t vertex_index = static_cast<uint32_t>(V.size());
-        V.push_back({new_vertex.x, new_vertex.y, new_vertex.z});
-        edge_to_vertex[edge_key] = vertex_index;
+// 滑动切片边索引缓存（替代全局 edge→vertex 哈希表）：
+// x/y 边按平面存储，lo 为当前层下平面 z，hi 为上平面 z+1；z 边只属于当前层。
+// 每层结束后交换 lo/hi，内存固定为约 2 个切片，查找为 O(1) 直接寻址。
+// Index 为顶点编号类型：内存中的网格用 uint32_t，流式输出用 uint64_t。
+template <typename Index>
+struct EdgeSlices {
+    explicit EdgeSlices(size_t plane) : xLo(plane), xHi(plane), yLo(plane), yHi(plane), z(plane) {}
+
+    // 上平面成为下一层的下平面；新的上平面槽位无需清空，读取前必定已被本层覆盖
+    void next_layer() {
+        std::swap(xLo, xHi);
+        std::swap(yLo, yHi);
+    }
 
-        return vertex_index;
+    std::vector<Index> xLo, xHi, yLo, yHi, z;
+};
+
+// 提取单元层 z：lower 指向平面 z，平面 z+1 紧随其后。
+// 新顶点取 nextVertex 编号并交给 emitVertex(编号, 坐标, 端点1, 端点2, 端点值1, 端点值2)；
+// 三角形交给 emitTriangle(a, b, c)。
+// lowerExternal 时下平面的边 (0..3) 已由前一个 slab 创建，相应角点先经
+// emitExternal(角点序号, (平面偏移 << 1) | 轴) 记录，三角形中该角点暂写 0。
+template <typename Rows, typename T, typename Index, typename VertexFn, typename ExternalFn, typename TriangleFn>
+void extract_layer(Rows &rows, const T *lower, int nx, int ny, int z, float iso, bool lowerExternal,
+                   EdgeSlices<Index> &slices, Index &nextVertex,
+                   VertexFn &&emitVertex, ExternalFn &&emitExternal, TriangleFn &&emitTriangle) {
+    // 每条物理边由扫描顺序 (z, y, x) 中第一个包含它的单元创建（见 owned_edges）；
+    // 其余单元直接读取缓存槽位。创建顺序与插值方向均与原哈希表实现一致，
+    // 因此输出网格逐字节相同。
+    const auto get_edge_vertex = [&](Index &slot, bool owned,
+                                     float val1, float val2, const EdgeVertex &p1, const EdgeVertex &p2) -> Index {
+        if (!owned) return slot;
+
+        EdgeVertex new_vertex = vertex_lerp(iso, p1, p2, val1, val2);
+        slot = nextVertex++;
+        emitVertex(slot, new_vertex, p1, p2, val1, val2);
+        return slot;
     };
 
-    for (int z = 0; z < nz - 1; ++z) {
-        for (int y = 0; y < ny - 1; ++y) {
-            for (int x = 0; x < nx - 1; ++x) {
-                float val[8];
-                val[0] = vol[idx(x, y, z)];
-                val[1] = vol[idx(x+1, y, z)];
-                val[2] = vol[idx(x+1, y+1, z)];
-                val[3] = vol[idx(x, y+1, z)];
-                val[4] = vol[idx(x, y, z+1)];
-                val[5] = vol[idx(x+1, y, z+1)];
-                val[6] = vol[idx(x+1, y+1, z+1)];
-                val[7] = vol[idx(x, y+1, z+1)];
-
-                // 在等值处采用一致的侧选原则：对 iso 施加微小负偏置，避免相邻体素因浮点误差做出不同判断而产生裂缝
-                const float isoBias = iso - 1e-6f;
-                int cubeindex = 0;
-                if (val[0] < isoBias) cubeindex |= 1;
-                if (val[1] < isoBias) cubeindex |= 2;
-                if (val[2] < isoBias) cubeindex |= 4;
-                if (val[3] < isoBias) cubeindex |= 8;
-                if (val[4] < isoBias) cubeindex |= 16;
-                if (val[5] < isoBias) cubeindex |= 32;
-                if (val[6] < isoBias) cubeindex |= 64;
-                if (val[7] < isoBias) cubeindex |= 128;
-
-                int edges = edgeTable[cubeindex];
-                if (edges == 0) continue;
-
-                EdgeVertex p[8] = {
-                    {static_cast<float>(x),   static_cast<float>(y),   static_cast<float>(z)},
-                    {static_cast<float>(x+1), static_cast<float>(y),   static_cast<float>(z)},
-                    {static_cast<float>(x+1), static_cast<float>(y+1), static_cast<float>(z)},
-                    {static_cast<float>(x),   static_cast<float>(y+1), static_cast<float>(z)},
-                    {static_cast<float>(x),   static_cast<float>(y),   static_cast<float>(z+1)},
-                    {static_cast<float>(x+1), static_cast<float>(y),   static_cast<float>(z+1)},
-                    {static_cast<float>(x+1), static_cast<float>(y+1), static_cast<float>(z+1)},
-                    {static_cast<float>(x),   static_cast<float>(y+1), static_cast<float>(z+1)}
-                };
-
-                uint32_t vertIndices[12] = {0}; // physical edge indices (0..11)
-
-                // Process each edge that contributes to triangles
-                if (edges & 1)    vertIndices[0]  = get_edge_vertex(x,   y,   z,   x+1, y,   z,   val[0], val[1], p[0], p[1]);
-                if (edges & 2)    vertIndices[1]  = get_edge_vertex(x+1, y,   z,   x+1, y+1, z,   val[1], val[2], p[1], p[2]);
-                if (edges & 4)    vertIndices[2]  = get_edge_vertex(x+1, y+1, z,   x,   y+1, z,   val[2], val[3], p[2], p[3]);
-                if (edges & 8)    vertIndices[3]  = get_edge_vertex(x,   y+1, z,   x,   y,   z,   val[3], val[0], p[3], p[0]);
-                if (edges & 16)   vertIndices[4]  = get_edge_vertex(x,   y,   z+1, x+1, y,   z+1, val[4], val[5], p[4], p[5]);
-                if (edges & 32)   vertIndices[5]  = get_edge_vertex(x+1, y,   z+1, x+1, y+1, z+1, val[5], val[6], p[5], p[6]);
-                if (edges & 64)   vertIndices[6]  = get_edge_vertex(x+1, y+1, z+1, x,   y+1, z+1, val[6], val[7], p[6], p[7]);
-                if (edges & 128)  vertIndices[7]  = get_edge_vertex(x,   y+1, z+1, x,   y,   z+1, val[7], val[4], p[7], p[4]);
-                if (edges & 256)  vertIndices[8]  = get_edge_vertex(x,   y,   z,   x,   y,   z+1, val[0], val[4], p[0], p[4]);
-                if (edges & 512)  vertIndices[9]  = get_edge_vertex(x+1, y,   z,   x+1, y,   z+1, val[1], val[5], p[1], p[5]);
-                // standard mapping
-                if (edges & 1024) vertIndices[10] = get_edge_vertex(x+1, y+1, z,   x+1, y+1, z+1, val[2], val[6], p[2], p[6]);
-                if (edges & 2048) vertIndices[11] = get_edge_vertex(x,   y+1, z,   x,   y+1, z+1, val[3], val[7], p[3], p[7]);
-
-                // 构建与 triTable 索引一致的顶点索引视图（应用 10/11 对调）
-                uint32_t triEdgeVert[12] = {0};
-                for (int ei = 0; ei < 12; ++ei) {
-                    int bit = 1 << edge_index_map[ei];
-                    if (edges & bit) triEdgeVert[ei] = vertIndices[edge_index_map[ei]];
-                }
+    rows.begin_layer(lower, z);
+    for (int y = 0; y < ny - 1; ++y) {
+        if (rows.classify_row(y) == 0) continue;
+        rows.for_each_active([&](int x) {
+            // 平面内偏移：(x,y) (x+1,y) (x,y+1) (x+1,y+1)
+            const size_t c00 = static_cast<size_t>(y) * nx + x;
+            const size_t c10 = c00 + 1;
+            const size_t c01 = c00 + nx;
+            const size_t c11 = c01 + 1;
 
-                // Generate triangles
-                for (int i = 0; i < 16; i += 3) {
-                    int ia = triTable[cubeindex][i];
-                    if (ia == -1) break;
-                    int ib = (i+1 < 16) ? triTable[cubeindex][i+1] : -1;
-                    int ic = (i+2 < 16) ? triTable[cubeindex][i+2] : -1;
-                    if (ib == -1 || ic == -1) break;
-                    if (ia < 0 || ia > 11 || ib < 0 || ib > 11 || ic < 0 || ic > 11) continue;
+            // 活跃单元才读取角点值，仅插值时转换为浮点
+            const int cubeindex = rows.cube(x);
+            float val[8];
+            rows.corner_values(lower, c00, cubeindex, val);
+            const int edges = edgeTable[cubeindex];
+
+            EdgeVertex p[8] = {
+                {static_cast<float>(x),   static_cast<float>(y),   static_cast<float>(z)},
+                {static_cast<float>(x+1), static_cast<float>(y),   static_cast<float>(z)},
+                {static_cast<float>(x+1), static_cast<float>(y+1), static_cast<float>(z)},
+                {static_cast<float>(x),   static_cast<float>(y+1), static_cast<float>(z)},
+                {static_cast<float>(x),   static_cast<float>(y),   static_cast<float>(z+1)},
+                {static_cast<float>(x+1), static_cast<float>(y),   static_cast<float>(z+1)},
+                {static_cast<float>(x+1), static_cast<float>(y+1), static_cast<float>(z+1)},
+                {static_cast<float>(x),   static_cast<float>(y+1), static_cast<float>(z+1)}
+            };
+
+            const int owned = owned_edge_mask(x, y, z);
+            Index vertIndices[12] = {0};    // physical edge indices (0..11)
+            uint64_t externalKey[4] = {0};  // 外部下平面边 0..3 的键
+
+            // 下平面 z 的边：z>z0 时均已由上一层单元（边 4..7）创建
+            if (lowerExternal) {
+                externalKey[0] = (static_cast<uint64_t>(c00) << 1) | 0;
+                externalKey[1] = (static_cast<uint64_t>(c10) << 1) | 1;
+                externalKey[2] = (static_cast<uint64_t>(c01) << 1) | 0;
+                externalKey[3] = (static_cast<uint64_t>(c00) << 1) | 1;
+            } else {
+                if (edges & 1) vertIndices[0] = get_edge_vertex(slices.xLo[c00], owned & 1, val[0], val[1], p[0], p[1]);
+                if (edges & 2) vertIndices[1] = get_edge_vertex(slices.yLo[c10], owned & 2, val[1], val[2], p[1], p[2]);
+                if (edges & 4) vertIndices[2] = get_edge_vertex(slices.xLo[c01], owned & 4, val[2], val[3], p[2], p[3]);
+                if (edges & 8) vertIndices[3] = get_edge_vertex(slices.yLo[c00], owned & 8, val[3], val[0], p[3], p[0]);
+            }
+            // 上平面 z+1 的边：只可能由同层 y-1 / x-1 的相邻单元创建
+            if (edges & 16)   vertIndices[4]  = get_edge_vertex(slices.xHi[c00], owned & 16,   val[4], val[5], p[4], p[5]);
+            if (edges & 32)   vertIndices[5]  = get_edge_vertex(slices.yHi[c10], owned & 32,   val[5], val[6], p[5], p[6]);
+            if (edges & 64)   vertIndices[6]  = get_edge_vertex(slices.xHi[c01], owned & 64,   val[6], val[7], p[6], p[7]);
+            if (edges & 128)  vertIndices[7]  = get_edge_vertex(slices.yHi[c00], owned & 128,  val[7], val[4], p[7], p[4]);
+            // 层内 z 方向的边
+            if (edges & 256)  vertIndices[8]  = get_edge_vertex(slices.z[c00],   owned & 256,  val[0], val[4], p[0], p[4]);
+            if (edges & 512)  vertIndices[9]  = get_edge_vertex(slices.z[c10],   owned & 512,  val[1], val[5], p[1], p[5]);
+            // standard mapping
+            if (edges & 1024) vertIndices[10] = get_edge_vertex(slices.z[c11],   owned & 1024, val[2], val[6], p[2], p[6]);
+            if (edges & 2048) vertIndices[11] = get_edge_vertex(slices.z[c01],   owned & 2048, val[3], val[7], p[3], p[7]);
+
+            // 构建与 triTable 索引一致的顶点索引视图（应用 10/11 对调）
+            Index triEdgeVert[12] = {0};
+            for (int ei = 0; ei < 12; ++ei) {
+                int bit = 1 << edge_index_map[ei];
+                if (edges & bit) triEdgeVert[ei] = vertIndices[edge_index_map[ei]];
+            }
 
-                    // Check if all edge vertices were actually created (with mapped bits)
-                    if ((edges & (1 << edge_index_map[ia])) == 0 || (edges & (1 << edge_index_map[ib])) == 0 || (edges & (1 << edge_index_map[ic])) == 0) continue;
+            // Generate triangles
+            for (int i = 0; i < 16; i += 3) {
+                int ia = triTable[cubeindex][i];
+                if (ia == -1) break;
+                int ib = (i+1 < 16) ? triTable[cubeindex][i+1] : -1;
+                int ic = (i+2 < 16) ? triTable[cubeindex][i+2] : -1;
+                if (ib == -1 || ic == -1) break;
+                if (ia < 0 || ia > 11 || ib < 0 || ib > 11 || ic < 0 || ic > 11) continue;
 
-                    T.push_back({triEdgeVert[ia], triEdgeVert[ib], triEdgeVert[ic]});
+                // 外部边 (0..3 在 triTable 中编号不变) 先写占位，合并后回填
+                if (lowerExternal) {
+                    const int corners[3] = {ia, ib, ic};
+                    for (int k = 0; k < 3; ++k) {
+                        if (corners[k] < 4) emitExternal(k, externalKey[corners[k]]);
+                    }
                 }
+
+                emitTriangle(triEdgeVert[ia], triEdgeVert[ib], triEdgeVert[ic]);
+            }
+        });
+    }
+}
+
+// 第二遍：按预先计算的偏移直接写入最终输出，线程间无需加锁
+// iso 为插值用的等值（掩码模式下为 kMaskIso）
+template <typename Rows, typename T>
+void fill_slab(Rows &rows, const T *vol, int nx, int ny, int nz, float iso, SlabTask &task,
+               MCVertex *outVertices, MCTriangle *outTriangles, MCNormal *outNormals) {
+    const size_t plane = static_cast<size_t>(nx) * static_cast<size_t>(ny);
+    uint32_t nextVertex = static_cast<uint32_t>(task.vertexOffset);
+    size_t nextTriangle = task.triangleOffset;
+    task.patches.clear();
+
+    EdgeSlices<uint32_t> slices(plane);
+    for (int z = task.z0; z < task.z1; ++z) {
+        // slab 首层且 z0>0 时，下平面 z 的边 (0..3) 已由前一个 slab 创建，记录待解析的引用
+        const bool lowerExternal = z == task.z0 && task.z0 > 0;
+        extract_layer(rows, vol + static_cast<size_t>(z) * plane, nx, ny, z, iso, lowerExternal, slices, nextVertex,
+            [&](uint32_t id, const EdgeVertex &v, const EdgeVertex &p1, const EdgeVertex &p2, float val1, float val2) {
+                outVertices[id] = {v.x, v.y, v.z};
+                if (outNormals) outNormals[id] = edge_normal(vol, nx, ny, nz, iso, p1, p2, val1, val2);
+            },
+            [&](int corner, uint64_t key) { task.patches.emplace_back(nextTriangle * 3 + corner, key); },
+            [&](uint32_t a, uint32_t b, uint32_t c) { outTriangles[nextTriangle++] = {a, b, c}; });
+        slices.next_layer();
+    }
+
+    // 最后一次交换后 lo 即为上平面 z1
+    task.xTop = std::move(slices.xLo);
+    task.yTop = std::move(slices.yLo);
+}
+
+} // namespace
+
+template <typename Voxel>
+void marching_cubes(const Voxel *vol, int nx, int ny, int nz, float iso,
+                    std::vector<MCVertex> &V, std::vector<MCTriangle> &T, const MCOptions &options) {
+    if (options.engine == MCEngine::FlyingEdges) {
+        flying_edges(vol, nx, ny, nz, iso, V, T, options);
+        return;
+    }
+    if (options.engine == MCEngine::SurfaceNets) {
+        surface_nets(vol, nx, ny, nz, iso, V, T, options);
+        return;
+    }
+    V.clear(); T.clear();
+    if (options.normals) options.normals->clear();
+    if (nx < 2 || ny < 2 || nz < 2) return;
+
+    const int numThreads = options.numThreads;
+    const ActiveBricks *bricks = options.activeBricks;
+    if (bricks && (bricks->bricksX != bricks_along(nx) || bricks->bricksY != bricks_along(ny) ||
+                   bricks->bricksZ != bricks_along(nz))) {
+        bricks = nullptr; // 与体数据尺寸不匹配的索引不可用，退回全量扫描
+    }
+
+    // 按单元层均分为 z-slab；slab 数不超过线程数与层数
+    const int layers = nz - 1;
+    const int numSlabs = std::max(1, std::min(numThreads, layers));
+    std::vector<SlabTask> slabs(static_cast<size_t>(numSlabs));
+    for (int s = 0; s < numSlabs; ++s) {
+        slabs[static_cast<size_t>(s)].z0 = static_cast<int>(static_cast<int64_t>(layers) * s / numSlabs);
+        slabs[static_cast<size_t>(s)].z1 = static_cast<int>(static_cast<int64_t>(layers) * (s + 1) / numSlabs);
+    }
+
+    // 掩码模式：体数据先按等值压成每体素 1 位，两遍都只读位数据
+    BitMaskVolume mask;
+    if (options.binaryMask) mask.build(vol, nx, ny, nz, iso, numThreads);
+    const auto with_rows = [&](auto &&fn) {
+        if (options.binaryMask) {
+            PackedRowClassifier rows(mask, nx);
+            fn(rows, kMaskIso);
+        } else {
+            RowClassifier<Voxel> rows(nx, ny, iso - 1e-6f, bricks);
+            fn(rows, iso);
+        }
+    };
+
+    // 第一遍：分类并计数
+    parallel_for(numSlabs, numSlabs, [&](int s) {
+        with_rows([&](auto &rows, float) { count_slab(rows, vol, nx, ny, slabs[static_cast<size_t>(s)]); });
+    });
+
+    // 顶点/三角形偏移前缀和，输出只分配一次
+    size_t totalVertices = 0, totalTriangles = 0;
+    for (auto &slab : slabs) {
+        slab.vertexOffset = totalVertices;
+        slab.triangleOffset = totalTriangles;
+        totalVertices += slab.vertexCount;
+        totalTriangles += slab.triangleCount;
+    }
+    V.resize(totalVertices);
+    T.resize(totalTriangles);
+    MCNormal *normals = nullptr;
+    if (options.normals) {
+        options.normals->resize(totalVertices);
+        normals = options.normals->data();
+    }
+
+    // 第二遍：各 slab 写入各自的区间；slab 内顺序即串行扫描顺序，结果与线程数无关
+    parallel_for(numSlabs, numSlabs, [&](int s) {
+        with_rows([&](auto &rows, float lerpIso) {
+            fill_slab(rows, vol, nx, ny, nz, lerpIso, slabs[static_cast<size_t>(s)], V.data(), T.data(), normals);
+        });
+    });
+
+    // 回填 slab 边界：外部引用取前一个 slab 上平面缓存中的全局编号
+    parallel_for(numSlabs, numSlabs, [&](int si) {
+        const size_t s = static_cast<size_t>(si);
+        for (const auto &patch : slabs[s].patches) {
+            const SlabTask &prev = slabs[s - 1];
+            const size_t pos = static_cast<size_t>(patch.second >> 1);
+            const uint32_t vertex = (patch.second & 1) ? prev.yTop[pos] : prev.xTop[pos];
+            MCTriangle &tri = T[patch.first / 3];
+            switch (patch.first % 3) {
+                case 0: tri.a = vertex; break;
+                case 1: tri.b = vertex; break;
+                default: tri.c = vertex; break;
             }
         }
+    });
+}
+
+template void marching_cubes<float>(const float *, int, int, int, float,
+                                    std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void marching_cubes<uint8_t>(const uint8_t *, int, int, int, float,
+                                      std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void marching_cubes<int16_t>(const int16_t *, int, int, int, float,
+                                      std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void marching_cubes<uint16_t>(const uint16_t *, int, int, int, float,
+                                       std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+
+template <typename T>
+bool marching_cubes_streaming(const MCPlaneReader<T> &readPlane, int nx, int ny, int nz, float iso,
+                              MCMeshSink &sink, std::string &errorMessage) {
+    if (nx < 2 || ny < 2 || nz < 2) return true;
+
+    // 常驻数据：相邻两个体素平面 + 边索引切片 + 一层的输出
+    const size_t plane = static_cast<size_t>(nx) * static_cast<size_t>(ny);
+    std::vector<T> planes(plane * 2);
+    if (!readPlane(0, planes.data(), errorMessage)) return false;
+
+    EdgeSlices<uint64_t> slices(plane);
+    RowClassifier<T> rows(nx, ny, iso - 1e-6f, nullptr);
+    uint64_t nextVertex = 0;
+    MCMeshBatch batch;
+    for (int z = 0; z < nz - 1; ++z) {
+        // 上一层的上平面下移为本层的下平面，再读入新的上平面
+        if (z > 0) std::copy(planes.begin() + static_cast<std::ptrdiff_t>(plane), planes.end(), planes.begin());
+        if (!readPlane(z + 1, planes.data() + plane, errorMessage)) return false;
+
+        extract_layer(rows, planes.data(), nx, ny, z, iso, false, slices, nextVertex,
+            [&](uint64_t, const EdgeVertex &v, const EdgeVertex &, const EdgeVertex &, float, float) {
+                batch.vertices.push_back({v.x, v.y, v.z});
+            },
+            [](int, uint64_t) {},
+            [&](uint64_t a, uint64_t b, uint64_t c) { batch.triangles.push_back({a, b, c}); });
+        slices.next_layer();
+
+        if (batch.vertices.empty() && batch.triangles.empty()) continue;
+        if (!sink.consume(std::move(batch), errorMessage)) return false;
+        batch = MCMeshBatch();
     }
-}
\ No newline at end of file
+    return true;
+}
+
+template bool marching_cubes_streaming<float>(const MCPlaneReader<float> &, int, int, int, float,
+                                              MCMeshSink &, std::string &);
+template bool marching_cubes_streaming<uint8_t>(const MCPlaneReader<uint8_t> &, int, int, int, float,
+                                                MCMeshSink &, std::string &);
+template bool marching_cubes_streaming<int16_t>(const MCPlaneReader<int16_t> &, int, int, int, float,
+                                                MCMeshSink &, std::string &);
+template bool marching_cubes_streaming<uint16_t>(const MCPlaneReader<uint16_t> &, int, int, int, float,
+                                                 MCMeshSink &, std::string &);
@@ -2,17 +2,112 @@
 
 #include <array>
 #include <cstdint>
+#include <functional>
+#include <string>
 #include <vector>
 
+#include "block_index.h"
+
 struct MCVertex { float x, y, z; };
 struct MCTriangle { uint32_t a, b, c; };
+// Quad of the Surface Nets engine (MCOptions::quads), corners in winding order.
+struct MCQuad { uint32_t a, b, c, d; };
+// Unit vertex normal along the volume gradient (towards higher voxel values),
+// on the same side as the triangle winding.
+struct MCNormal { float x, y, z; };
+// Streamed meshes can exceed 2^32 vertices, so their indices are 64-bit.
+struct MCTriangle64 { uint64_t a, b, c; };
+
+// Extraction algorithm. MarchingCubes walks active cells with sliding edge
+// slices; FlyingEdges (Schroeder et al. 2015) runs four edge-centric passes over
+// voxel rows: x-edge classification, row trimming and y/z-edge/triangle counts,
+// a prefix sum of per-row counts, then generation into precomputed ranges.
+// Both produce the same surface; vertex numbering differs (Flying Edges
+// numbers the x-, y- then z-edge vertices of each voxel row).
+// SurfaceNets (naive Surface Nets, Gibson 1998) is a dual method: one vertex per
+// active cell at the mean of its edge crossings, and one quad per cut interior
+// edge joining the four cells around it. Border cells whose only cut edges lie
+// on the volume border join no quad and get no vertex. The quads are returned
+// as such through MCOptions::quads, or split along their shorter diagonal
+// (triangles 2k and 2k+1 are the halves of quad k). The surface is slightly
+// different (it stops half a cell short of the volume border).
+// Measured against MarchingCubes, triangle output has about the same number of
+// vertices and triangles (up to ~45% more on sparse masks of isolated voxels),
+// so its gain is triangle shape (far fewer slivers). The primitive count is
+// halved only in quad mode (MCOptions::quads): use it to get the reduction.
+enum class MCEngine { MarchingCubes, FlyingEdges, SurfaceNets };
+
+struct MCOptions {
+    // > 1 splits the volume into z-slabs extracted in parallel; the output is
+    // byte-identical for every thread count.
+    int numThreads = 1;
+    // Optional: only visit bricks marked active for this iso value (see
+    // MinMaxBlockIndex::find_active). Skipped bricks contain no surface, so the
+    // output is identical to a full sweep.
+    const ActiveBricks *activeBricks = nullptr;
+    // Optional: receives one normal per output vertex, computed in the same
+    // pass from central-difference volume gradients (one-sided at the volume
+    // border) interpolated along the vertex's edge. Zero where the gradient
+    // vanishes.
+    std::vector<MCNormal> *normals = nullptr;
+    // Flying Edges and Surface Nets ignore activeBricks.
+    MCEngine engine = MCEngine::MarchingCubes;
+    // Optional (SurfaceNets only): receives the quads, and outTriangles is left
+    // empty. triangulate_quads() gives the triangles the engine would emit.
+    std::vector<MCQuad> *quads = nullptr;
+    // Binary mask mode (MarchingCubes engine only): the volume is classified
+    // once and packed to one bit per voxel (see BitMaskVolume); cells are then
+    // classified 64 at a time from the packed words and vertices are placed at
+    // edge midpoints without reading voxel values. For a 0/1 mask at iso 0.5
+    // this is the same mesh as the default mode. activeBricks is ignored.
+    bool binaryMask = false;
+};
 
 // Generate triangle mesh for the isosurface.
 // Input volume layout: index = z*(ny*nx) + y*nx + x, dimensions (nx, ny, nz)
-void marching_cubes(const float *volume,
+// Instantiated for float, uint8_t, int16_t and uint16_t voxels. Integer volumes
+// are classified in their native width (value < ceil(iso - 1e-6f)); values are
+// converted to float only for edge interpolation, so the mesh matches the one
+// extracted from the same volume widened to float.
+template <typename T>
+void marching_cubes(const T *volume,
                     int nx, int ny, int nz,
                     float isoValue,
                     std::vector<MCVertex> &outVertices,
-                    std::vector<MCTriangle> &outTriangles);
+                    std::vector<MCTriangle> &outTriangles,
+                    const MCOptions &options = MCOptions());
+
+// Split each quad along its shorter diagonal, as the Surface Nets engine does
+// when MCOptions::quads is not set: quad k becomes triangles 2k and 2k+1.
+void triangulate_quads(const std::vector<MCVertex> &vertices, const std::vector<MCQuad> &quads,
+                       std::vector<MCTriangle> &triangles);
+
+// Output of one cell layer in streaming mode. Vertices are numbered
+// consecutively across batches in the order they are delivered.
+struct MCMeshBatch {
+    std::vector<MCVertex> vertices;
+    std::vector<MCTriangle64> triangles;
+};
+
+// Incremental consumer of streamed mesh batches (see VtkStreamWriter).
+class MCMeshSink {
+public:
+    virtual ~MCMeshSink() = default;
+    virtual bool consume(MCMeshBatch &&batch, std::string &errorMessage) = 0;
+};
 
+// Loads z-plane z (nx*ny voxels) into dst.
+template <typename T>
+using MCPlaneReader = std::function<bool(int z, T *dst, std::string &errorMessage)>;
 
+// Out-of-core variant of marching_cubes(): planes are requested in increasing
+// z, only two are resident at a time, and each finished cell layer is handed
+// to the sink. Vertex order and triangle order are the same as for
+// marching_cubes() on the whole volume. Same voxel types as marching_cubes().
+// Normals are not available in this mode (they need the planes z-1 and z+2).
+template <typename T>
+bool marching_cubes_streaming(const MCPlaneReader<T> &readPlane,
+                              int nx, int ny, int nz,
+                              float isoValue,
+                              MCMeshSink &sink,
+                              std::string &errorMessage);
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "cube_classify.h"
+#include "marching_cubes.h"
+
+// Pieces shared by the extraction engines (marching_cubes.cpp, flying_edges.cpp,
+// surface_nets.cpp, multi_label.cpp):
+// the case tables, edge interpolation, gradient normals, voxel thresholds, and
+// the slab and active-cell loops.
+
+// Marching Cubes case tables, defined in marching_cubes.cpp. edgeTable bits and
+// corners follow Bourke's numbering; triTable edge 10/11 are swapped relative
+// to edgeTable (see edge_index_map).
+extern const int edgeTable[256];
+extern const int triTable[256][16];
+
+struct EdgeVertex { float x, y, z; };
+
+inline EdgeVertex vertex_lerp(float iso, const EdgeVertex &p1, const EdgeVertex &p2, float valp1, float valp2) {
+    const float EPS = 1e-6f;
+    const float diff = valp2 - valp1;
+    if (std::fabs(iso - valp1) < EPS) return p1;
+    if (std::fabs(iso - valp2) < EPS) return p2;
+    if (std::fabs(diff) < EPS) {
+        return { (p1.x + p2.x) * 0.5f, (p1.y + p2.y) * 0.5f, (p1.z + p2.z) * 0.5f };
+    }
+    const float mu = (iso - valp1) / diff;
+    return { p1.x + mu * (p2.x - p1.x), p1.y + mu * (p2.y - p1.y), p1.z + mu * (p2.z - p1.z) };
+}
+
+// Interpolation parameter t of vertex_lerp (vertex = p1 + t*(p2-p1)), with the
+// same special cases.
+inline float edge_weight(float iso, float valp1, float valp2) {
+    const float EPS = 1e-6f;
+    const float diff = valp2 - valp1;
+    if (std::fabs(iso - valp1) < EPS) return 0.0f;
+    if (std::fabs(iso - valp2) < EPS) return 1.0f;
+    if (std::fabs(diff) < EPS) return 0.5f;
+    return (iso - valp1) / diff;
+}
+
+// Gradient of value(voxel) at grid point (x,y,z): central differences inside,
+// one-sided at the border.
+template <typename T, typename ValueFn>
+inline void field_gradient(const T *vol, int nx, int ny, int nz, int x, int y, int z, ValueFn &&value, float g[3]) {
+    const size_t sy = static_cast<size_t>(nx);
+    const size_t sz = sy * static_cast<size_t>(ny);
+    const T *v = vol + static_cast<size_t>(z) * sz + static_cast<size_t>(y) * sy + static_cast<size_t>(x);
+    const auto diff = [v, &value](int at, int n, size_t stride) {
+        const float lo = value(at > 0 ? v[-static_cast<std::ptrdiff_t>(stride)] : v[0]);
+        const float hi = value(at < n - 1 ? v[stride] : v[0]);
+        return (at > 0 && at < n - 1) ? (hi - lo) * 0.5f : hi - lo;
+    };
+    g[0] = diff(x, nx, 1);
+    g[1] = diff(y, ny, sy);
+    g[2] = diff(z, nz, sz);
+}
+
+// Volume gradient at grid point (x,y,z).
+template <typename T>
+inline void voxel_gradient(const T *vol, int nx, int ny, int nz, int x, int y, int z, float g[3]) {
+    field_gradient(vol, nx, ny, nz, x, y, z, [](T v) { return static_cast<float>(v); }, g);
+}
+
+// Normal of the vertex on edge p1-p2 of the field value(voxel): endpoint
+// gradients interpolated with the vertex parameter and normalized. Points
+// towards higher values, matching the triTable winding.
+template <typename T, typename ValueFn>
+MCNormal field_edge_normal(const T *vol, int nx, int ny, int nz, ValueFn &&value, float iso,
+                           const EdgeVertex &p1, const EdgeVertex &p2, float val1, float val2) {
+    float g1[3], g2[3];
+    field_gradient(vol, nx, ny, nz, static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p1.z), value, g1);
+    field_gradient(vol, nx, ny, nz, static_cast<int>(p2.x), static_cast<int>(p2.y), static_cast<int>(p2.z), value, g2);
+    const float t = edge_weight(iso, val1, val2);
+    float n[3];
+    for (int k = 0; k < 3; ++k) n[k] = g1[k] + t * (g2[k] - g1[k]);
+    const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (!(len > 0.0f)) return {0.0f, 0.0f, 0.0f};
+    return {n[0] / len, n[1] / len, n[2] / len};
+}
+
+// Normal of the vertex on edge p1-p2 from the volume gradient.
+template <typename T>
+MCNormal edge_normal(const T *vol, int nx, int ny, int nz, float iso,
+                     const EdgeVertex &p1, const EdgeVertex &p2, float val1, float val2) {
+    return field_edge_normal(vol, nx, ny, nz, [](T v) { return static_cast<float>(v); }, iso, p1, p2, val1, val2);
+}
+
+// triTable edge index -> edgeTable bit (10 and 11 swapped).
+inline constexpr int edge_index_map[12] = {0,1,2,3,4,5,6,7,8,9,11,10};
+
+// Corners (p1, p2) of each physical edge (edgeTable bit), in the interpolation
+// order used by the marching-cubes engine.
+inline constexpr int kEdgeCorners[12][2] = {
+    {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7},
+};
+
+// Physical edges (edgeTable bits) that cell (x,y,z) creates: no earlier cell in
+// scan order (z, y, x) contains them. Indexed by (x==0) | (y==0)<<1 | (z==0)<<2.
+constexpr int owned_edges(bool x0, bool y0, bool z0) {
+    int m = 32 | 64 | 1024;                       // edges 5, 6 and 10 are always new
+    if (z0) m |= 2 | 4 | (y0 ? 1 : 0) | (x0 ? 8 : 0);
+    if (y0) m |= 16 | 512;
+    if (x0) m |= 128 | 2048;
+    if (x0 && y0) m |= 256;
+    return m;
+}
+
+inline constexpr int kOwnedEdges[8] = {
+    owned_edges(false, false, false), owned_edges(true, false, false),
+    owned_edges(false, true, false),  owned_edges(true, true, false),
+    owned_edges(false, false, true),  owned_edges(true, false, true),
+    owned_edges(false, true, true),   owned_edges(true, true, true),
+};
+
+inline int owned_edge_mask(int x, int y, int z) {
+    return kOwnedEdges[(x == 0 ? 1 : 0) | (y == 0 ? 2 : 0) | (z == 0 ? 4 : 0)];
+}
+
+// Runs fn(i) for i in [0, count), one thread per index when numThreads > 1.
+template <typename Fn>
+void parallel_for(int count, int numThreads, Fn &&fn) {
+    if (numThreads <= 1 || count <= 1) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) workers.emplace_back([&fn, i]() { fn(i); });
+    for (auto &w : workers) w.join();
+}
+
+// Runs fn(cell) for every set bit of a row's active-cell mask (bit c of word
+// w is cell 64w+c), in increasing order; zero words skip 64 cells at once.
+template <typename Fn>
+inline void for_each_active_cell(const uint64_t *active, size_t words, Fn &&fn) {
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t bits = active[w];
+        while (bits) {
+            fn(static_cast<int>(w * 64 + static_cast<size_t>(__builtin_ctzll(bits))));
+            bits &= bits - 1;
+        }
+    }
+}
+
+// Triangles emitted per cube configuration, following the triTable walk used
+// when generating them.
+struct TriangleCountTable {
+    uint8_t count[256];
+    TriangleCountTable() {
+        for (int c = 0; c < 256; ++c) {
+            int n = 0;
+            for (int i = 0; i + 2 < 16; i += 3) {
+                if (triTable[c][i] == -1 || triTable[c][i+1] == -1 || triTable[c][i+2] == -1) break;
+                ++n;
+            }
+            count[c] = static_cast<uint8_t>(n);
+        }
+    }
+};
+
+inline const TriangleCountTable &triangle_counts() {
+    static const TriangleCountTable table;
+    return table;
+}
+
+// Voxel classification threshold. Float voxels compare against isoBias directly;
+// for integer voxels v < isoBias is v < ceil(isoBias), compared in the native
+// width. A threshold outside the type's range makes every row constant, so no
+// voxels are read.
+template <typename T>
+class VoxelThreshold {
+public:
+    explicit VoxelThreshold(float isoBias) : isoBias_(isoBias) {
+        if constexpr (std::is_integral_v<T>) {
+            const double t = std::ceil(static_cast<double>(isoBias));
+            if (!(t > static_cast<double>(std::numeric_limits<T>::lowest()))) fill_ = 0;  // includes NaN
+            else if (t > static_cast<double>(std::numeric_limits<T>::max())) fill_ = 1;
+            else threshold_ = static_cast<T>(t);
+        }
+    }
+
+    void classify(const CubeClassifyKernels &kernels, const T *src, size_t n, uint8_t *mask) const {
+        if constexpr (std::is_same_v<T, float>) {
+            kernels.classifyBelow(src, n, isoBias_, mask);
+        } else {
+            if (fill_ >= 0) { std::memset(mask, fill_, n); return; }
+            if constexpr (std::is_same_v<T, uint8_t>) kernels.classifyBelowU8(src, n, threshold_, mask);
+            else if constexpr (std::is_same_v<T, int16_t>) kernels.classifyBelowI16(src, n, threshold_, mask);
+            else kernels.classifyBelowU16(src, n, threshold_, mask);
+        }
+    }
+
+private:
+    float isoBias_;
+    T threshold_ = T();
+    int fill_ = -1;   // 0/1: every voxel is not below / below
+};
+
+
+// Flying Edges engine (flying_edges.cpp), selected through MCOptions::engine.
+template <typename T>
+void flying_edges(const T *volume, int nx, int ny, int nz, float isoValue,
+                  std::vector<MCVertex> &outVertices, std::vector<MCTriangle> &outTriangles,
+                  const MCOptions &options);
+
+// Surface Nets engine (surface_nets.cpp), selected through MCOptions::engine.
+template <typename T>
+void surface_nets(const T *volume, int nx, int ny, int nz, float isoValue,
+                  std::vector<MCVertex> &outVertices, std::vector<MCTriangle> &outTriangles,
+                  const MCOptions &options);
@@ -0,0 +1,562 @@
+#include "mesh_decimate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+namespace {
+
+constexpr uint32_t kNone = 0xFFFFFFFFu;
+// 边界约束平面的权重（相对边长平方），使开放边界（体数据边缘）基本保持不动
+constexpr double kBoundaryWeight = 1000.0;
+// 分区阶段只简化到目标份额的这一倍数，余下的高代价折叠留给全局串行收尾按代价统一排序，
+// 避免某个分区（如小连通块密集处）为凑够份额而折叠本应保留的边
+constexpr double kRegionSlack = 1.5;
+// 自上次清理以来压入的条目超过堆大小的这一比例时，整体删除过期条目并重建堆。
+// 过期条目的代价低于其边的当前代价，不清理时几乎都会被逐个弹出（每次一趟完整下沉），
+// 简化比例高时弹出的过期条目可达有效折叠的近 10 倍
+constexpr double kHeapPurgeRatio = 0.2;
+// 每个分区的顶点数上限。折叠按代价顺序在整个区间内随机访问顶点、三角形与二次误差矩阵，
+// 大网格的工作集远超缓存；即使单线程也按此切成小分区依次简化，使每个分区的数据留在缓存中。
+// 8K 顶点时分区的候选边堆约 400KB；32K 时堆的逐层下沉以缓存缺失为主，总耗时多约 25%，
+// 4K 时锁定的交界顶点过多，收尾阶段的误差明显增大
+constexpr size_t kRegionVertices = 8192;
+
+// 对称 4x4 二次误差矩阵的上三角：a00 a01 a02 a03 a11 a12 a13 a22 a23 a33
+struct Quadric {
+    double q[10] = {0};
+
+    void add_plane(double nx, double ny, double nz, double d, double w) {
+        q[0] += w * nx * nx; q[1] += w * nx * ny; q[2] += w * nx * nz; q[3] += w * nx * d;
+        q[4] += w * ny * ny; q[5] += w * ny * nz; q[6] += w * ny * d;
+        q[7] += w * nz * nz; q[8] += w * nz * d;
+        q[9] += w * d * d;
+    }
+
+    Quadric &operator+=(const Quadric &o) {
+        for (int i = 0; i < 10; ++i) q[i] += o.q[i];
+        return *this;
+    }
+
+    double eval(double x, double y, double z) const {
+        return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+             + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+             + q[7] * z * z + 2 * q[8] * z + q[9];
+    }
+
+    // 误差最小点：解 A p = -b；矩阵接近奇异时返回 false
+    bool minimizer(double p[3]) const {
+        const double a00 = q[0], a01 = q[1], a02 = q[2], a11 = q[4], a12 = q[5], a22 = q[7];
+        const double c00 = a11 * a22 - a12 * a12;
+        const double c01 = a02 * a12 - a01 * a22;
+        const double c02 = a01 * a12 - a02 * a11;
+        const double det = a00 * c00 + a01 * c01 + a02 * c02;
+        const double scale = std::max({std::fabs(a00), std::fabs(a11), std::fabs(a22)});
+        if (!(std::fabs(det) > 1e-9 * scale * scale * scale)) return false;
+        const double c11 = a00 * a22 - a02 * a02;
+        const double c12 = a01 * a02 - a00 * a12;
+        const double c22 = a00 * a11 - a01 * a01;
+        const double b0 = -q[3], b1 = -q[6], b2 = -q[8];
+        p[0] = (c00 * b0 + c01 * b1 + c02 * b2) / det;
+        p[1] = (c01 * b0 + c11 * b1 + c12 * b2) / det;
+        p[2] = (c02 * b0 + c12 * b1 + c22 * b2) / det;
+        return std::isfinite(p[0]) && std::isfinite(p[1]) && std::isfinite(p[2]);
+    }
+};
+
+struct Vec3d { double x, y, z; };
+
+inline Vec3d to_vec(const MCVertex &v) { return {v.x, v.y, v.z}; }
+inline Vec3d sub(const Vec3d &a, const Vec3d &b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3d cross(const Vec3d &a, const Vec3d &b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+inline double dot(const Vec3d &a, const Vec3d &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+// 候选边（16 字节，堆中大量过期条目时仍紧凑）：stamp 为两端点版本号之和，
+// 版本号只增不减，和不变即两端均未改动；折叠位置在出堆时重新求解
+struct Candidate {
+    float cost;
+    uint32_t u, v;
+    uint32_t stamp;
+};
+
+// 每个分区线程独占的临时列表与邻接表内存池（分块分配，已分配的地址不会失效）
+struct Scratch {
+    static constexpr size_t kChunk = size_t(1) << 16;
+
+    std::vector<uint32_t> tu, tv, shared, nu, nbrs, list;
+    std::vector<std::unique_ptr<uint32_t[]>> chunks;
+    size_t used = kChunk;
+
+    uint32_t *allocate(size_t n) {
+        if (n > kChunk) {
+            chunks.emplace_back(new uint32_t[n]);
+            return chunks.back().get();
+        }
+        if (used + n > kChunk) {
+            chunks.emplace_back(new uint32_t[kChunk]);
+            used = 0;
+        }
+        uint32_t *p = chunks.back().get() + used;
+        used += n;
+        return p;
+    }
+};
+
+// 最小堆比较：代价相同时按 (u, v)，有效条目的弹出顺序与堆的内部排列（及清理时机）无关
+struct Worse {
+    bool operator()(const Candidate &a, const Candidate &b) const {
+        if (a.cost != b.cost) return a.cost > b.cost;
+        return a.u != b.u ? a.u > b.u : a.v > b.v;
+    }
+};
+
+class Decimator {
+public:
+    Decimator(std::vector<MCVertex> &vertices, std::vector<MCTriangle> &triangles, std::vector<MCNormal> *normals)
+        : V_(vertices), T_(triangles), N_(normals) {}
+
+    void run(size_t target, int numThreads) {
+        const size_t nv = V_.size(), nt = T_.size();
+        if (nt <= target || nv == 0) return;
+        build_adjacency();
+        triAlive_.assign(nt, 1);
+        alive_.assign(nv, 1);
+        stamp_.assign(nv, 0);
+
+        // 顶点按空间位置（Morton 序）切分为紧凑的分区，按关联三角形数均衡。分区数至少为线程数，
+        // 大网格再按 kRegionVertices 细分，多出的分区由各线程依次处理
+        const int parts = std::max({1, std::min<int>(numThreads, static_cast<int>(nv / 4096) + 1),
+                                    static_cast<int>(std::min<size_t>(nv / kRegionVertices, 4096))});
+        const int workers = std::max(1, std::min(numThreads, parts));
+        build_partitions(parts);
+
+        // 分区阶段：跨分区三角形的顶点锁定，各分区按其内部三角形数等比例简化（留 kRegionSlack 余量）
+        locked_.assign(nv, 0);
+        border_.assign(nv, 0);
+        quadrics_.assign(nv, Quadric());
+        run_parts(parts, workers, [&](int p) { build_quadrics(p); });
+        if (parts > 1) {
+            std::vector<size_t> regionTris(static_cast<size_t>(parts), 0);
+            for (const auto &t : T_) {
+                if (part_[t.a] == part_[t.b] && part_[t.a] == part_[t.c]) { ++regionTris[part_[t.a]]; continue; }
+                locked_[t.a] = locked_[t.b] = locked_[t.c] = 1;
+            }
+            scratch_.resize(static_cast<size_t>(parts));
+            run_parts(parts, workers, [&](int p) {
+                const size_t tris = regionTris[static_cast<size_t>(p)];
+                const size_t goal = static_cast<size_t>(kRegionSlack * static_cast<double>(tris) *
+                                                        static_cast<double>(target) / static_cast<double>(nt));
+                decimate_range(part_vertices(p), tris, goal, scratch_[static_cast<size_t>(p)]);
+            });
+            locked_.assign(nv, 0);
+        }
+
+        // 串行收尾：解锁后在整个网格上继续，去掉分区边界带上剩余的三角形（单分区时即全部工作）
+        const size_t live = static_cast<size_t>(std::count(triAlive_.begin(), triAlive_.end(), uint8_t(1)));
+        // 分区的内存池仍持有部分顶点的三角形表，收尾沿用第一个分区的池而不释放其余
+        if (scratch_.empty()) scratch_.resize(1);
+        decimate_range({partOrder_.data(), partOrder_.data() + nv}, live, target, scratch_[0]);
+        compact();
+    }
+
+private:
+    template <typename Fn>
+    static void run_parts(int parts, int numWorkers, Fn &&fn) {
+        if (numWorkers <= 1) {
+            for (int p = 0; p < parts; ++p) fn(p);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (int w = 0; w < numWorkers; ++w) {
+            workers.emplace_back([&fn, w, parts, numWorkers]() {
+                for (int p = w; p < parts; p += numWorkers) fn(p);
+            });
+        }
+        for (auto &w : workers) w.join();
+    }
+
+    struct VertexRange {
+        const uint32_t *first, *last;
+        const uint32_t *begin() const { return first; }
+        const uint32_t *end() const { return last; }
+    };
+
+    VertexRange part_vertices(int p) const {
+        return {partOrder_.data() + partBegin_[static_cast<size_t>(p)],
+                partOrder_.data() + partBegin_[static_cast<size_t>(p) + 1]};
+    }
+
+    // 顶点按包围盒内 64^3 网格单元的 Morton 码排序（同一单元内按编号），再按关联三角形数切成 parts 段。
+    // 提取输出的顶点按 z 序编号，直接按编号切分得到的是薄 z-slab，分区边界上锁定的顶点过多
+    void build_partitions(int parts) {
+        const size_t nv = V_.size();
+        float lo[3] = {V_[0].x, V_[0].y, V_[0].z}, hi[3] = {lo[0], lo[1], lo[2]};
+        for (const auto &v : V_) {
+            const float p[3] = {v.x, v.y, v.z};
+            for (int k = 0; k < 3; ++k) { lo[k] = std::min(lo[k], p[k]); hi[k] = std::max(hi[k], p[k]); }
+        }
+        const float extent = std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]});
+        const float scale = extent > 0.0f ? 63.999f / extent : 0.0f;
+        const auto spread = [](uint64_t x) {   // 6 位散开到每 3 位一位
+            uint64_t r = 0;
+            for (int b = 0; b < 6; ++b) r |= ((x >> b) & 1) << (3 * b);
+            return r;
+        };
+        std::vector<uint64_t> keys(nv);
+        for (size_t v = 0; v < nv; ++v) {
+            const float p[3] = {V_[v].x, V_[v].y, V_[v].z};
+            uint64_t code = 0;
+            for (int k = 0; k < 3; ++k) {
+                const uint64_t cell = static_cast<uint64_t>(std::clamp((p[k] - lo[k]) * scale, 0.0f, 63.0f));
+                code |= spread(cell) << k;
+            }
+            keys[v] = (code << 32) | v;
+        }
+        std::sort(keys.begin(), keys.end());
+
+        partOrder_.resize(nv);
+        part_.resize(nv);
+        partBegin_.assign(static_cast<size_t>(parts) + 1, static_cast<uint32_t>(nv));
+        partBegin_[0] = 0;
+        const size_t total = csrOffsets_[nv];
+        size_t weight = 0;
+        int p = 0;
+        for (size_t i = 0; i < nv; ++i) {
+            const uint32_t v = static_cast<uint32_t>(keys[i]);
+            while (p + 1 < parts && weight >= total * static_cast<size_t>(p + 1) / static_cast<size_t>(parts)) {
+                partBegin_[static_cast<size_t>(++p)] = static_cast<uint32_t>(i);
+            }
+            partOrder_[i] = v;
+            part_[v] = static_cast<uint16_t>(p);
+            weight += csrOffsets_[v + 1] - csrOffsets_[v];
+        }
+        // 分区内按编号排列
+        for (int q = 0; q < parts; ++q) std::sort(partOrder_.begin() + partBegin_[static_cast<size_t>(q)],
+                                                  partOrder_.begin() + partBegin_[static_cast<size_t>(q) + 1]);
+    }
+
+    // 顶点 → 三角形 CSR，只建一次；折叠后保留顶点的三角形表放不下时移到内存池（见 set_triangles）
+    void build_adjacency() {
+        const size_t nv = V_.size();
+        csrOffsets_.assign(nv + 1, 0);
+        for (const auto &t : T_) { ++csrOffsets_[t.a + 1]; ++csrOffsets_[t.b + 1]; ++csrOffsets_[t.c + 1]; }
+        for (size_t v = 0; v < nv; ++v) csrOffsets_[v + 1] += csrOffsets_[v];
+        csrTris_.resize(csrOffsets_[nv]);
+        std::vector<size_t> cursor(csrOffsets_.begin(), csrOffsets_.end() - 1);
+        for (size_t i = 0; i < T_.size(); ++i) {
+            const uint32_t id = static_cast<uint32_t>(i);
+            csrTris_[cursor[T_[i].a]++] = id;
+            csrTris_[cursor[T_[i].b]++] = id;
+            csrTris_[cursor[T_[i].c]++] = id;
+        }
+        adj_.resize(nv);
+        adjCount_.resize(nv);
+        adjCap_.resize(nv);
+        for (size_t v = 0; v < nv; ++v) {
+            adj_[v] = csrTris_.data() + csrOffsets_[v];
+            adjCount_[v] = adjCap_[v] = static_cast<uint32_t>(csrOffsets_[v + 1] - csrOffsets_[v]);
+        }
+    }
+
+    void set_triangles(uint32_t v, const std::vector<uint32_t> &tris, Scratch &s) {
+        if (tris.size() > adjCap_[v]) {
+            adj_[v] = s.allocate(tris.size());
+            adjCap_[v] = static_cast<uint32_t>(tris.size());
+        }
+        std::copy(tris.begin(), tris.end(), adj_[v]);
+        adjCount_[v] = static_cast<uint32_t>(tris.size());
+    }
+
+    // 遍历顶点 v 当前关联的存活三角形
+    template <typename Fn>
+    void for_each_triangle(uint32_t v, Fn &&fn) const {
+        const uint32_t *tris = adj_[v];
+        for (uint32_t i = 0; i < adjCount_[v]; ++i) {
+            if (triAlive_[tris[i]]) fn(tris[i]);
+        }
+    }
+
+    // 三角形所在平面（按面积加权）累加到三个顶点；只有一个三角形的边加入垂直约束平面
+    void build_quadrics(int p) {
+        std::vector<std::pair<uint32_t, uint32_t>> nbrs;   // (邻接顶点, 三角形)
+        for (uint32_t v : part_vertices(p)) {
+            Quadric &q = quadrics_[v];
+            nbrs.clear();
+            for (size_t i = csrOffsets_[v]; i < csrOffsets_[v + 1]; ++i) {
+                const uint32_t ti = csrTris_[i];
+                const MCTriangle &t = T_[ti];
+                const Vec3d a = to_vec(V_[t.a]), b = to_vec(V_[t.b]), c = to_vec(V_[t.c]);
+                const Vec3d n = cross(sub(b, a), sub(c, a));
+                const double len = std::sqrt(dot(n, n));
+                if (len > 0.0) {
+                    const Vec3d u = {n.x / len, n.y / len, n.z / len};
+                    q.add_plane(u.x, u.y, u.z, -dot(u, a), 0.5 * len);
+                }
+                for (uint32_t w : {t.a, t.b, t.c}) if (w != v) nbrs.emplace_back(w, ti);
+            }
+            std::sort(nbrs.begin(), nbrs.end());
+            for (size_t i = 0; i < nbrs.size(); ++i) {
+                const bool single = (i == 0 || nbrs[i - 1].first != nbrs[i].first) &&
+                                    (i + 1 == nbrs.size() || nbrs[i + 1].first != nbrs[i].first);
+                if (!single) continue;
+                border_[v] = 1;
+                const MCTriangle &t = T_[nbrs[i].second];
+                const Vec3d a = to_vec(V_[t.a]), b = to_vec(V_[t.b]), c = to_vec(V_[t.c]);
+                const Vec3d faceN = cross(sub(b, a), sub(c, a));
+                const Vec3d pv = to_vec(V_[v]);
+                const Vec3d edge = sub(to_vec(V_[nbrs[i].first]), pv);
+                const Vec3d n = cross(edge, faceN);
+                const double len = std::sqrt(dot(n, n));
+                if (!(len > 0.0)) continue;
+                const Vec3d u = {n.x / len, n.y / len, n.z / len};
+                q.add_plane(u.x, u.y, u.z, -dot(u, pv), kBoundaryWeight * dot(edge, edge));
+            }
+        }
+    }
+
+    // 折叠 (u, v) 的二次误差，pos 非空时给出折叠位置
+    float edge_cost(uint32_t u, uint32_t v, MCVertex *pos) const {
+        Quadric q = quadrics_[u];
+        q += quadrics_[v];
+        const Vec3d a = to_vec(V_[u]), b = to_vec(V_[v]);
+        const Vec3d mid = {(a.x + b.x) * 0.5, (a.y + b.y) * 0.5, (a.z + b.z) * 0.5};
+        const Vec3d e = sub(b, a);
+        double p[3];
+        Vec3d best;
+        double cost;
+        // 最优点离边太远（近奇异）时退回端点/中点中误差最小者
+        if (q.minimizer(p) && dot(sub({p[0], p[1], p[2]}, mid), sub({p[0], p[1], p[2]}, mid)) <= 4.0 * dot(e, e)) {
+            best = {p[0], p[1], p[2]};
+            cost = q.eval(p[0], p[1], p[2]);
+        } else {
+            best = a;
+            cost = q.eval(a.x, a.y, a.z);
+            for (const Vec3d &cand : {b, mid}) {
+                const double cc = q.eval(cand.x, cand.y, cand.z);
+                if (cc < cost) { cost = cc; best = cand; }
+            }
+        }
+        if (pos) *pos = {static_cast<float>(best.x), static_cast<float>(best.y), static_cast<float>(best.z)};
+        return static_cast<float>(std::max(cost, 0.0));
+    }
+
+    Candidate make_candidate(uint32_t u, uint32_t v) const {
+        if (u > v) std::swap(u, v);
+        return {edge_cost(u, v, nullptr), u, v, stamp_[u] + stamp_[v]};
+    }
+
+    // 条目压入后两端点均未改动（被并入的顶点版本号也加一，无需再查 alive_）
+    bool fresh(const Candidate &c) const {
+        return stamp_[c.u] + stamp_[c.v] == c.stamp;
+    }
+
+    // 简化顶点集 verts 内两端均未锁定的边，直到存活三角形数降到 target
+    void decimate_range(VertexRange verts, size_t liveTris, size_t target, Scratch &scratch) {
+        std::vector<Candidate> heap;
+        std::vector<uint32_t> &nbrs = scratch.nbrs;
+
+        // 初始候选：集合内每条两端均未锁定的存活边（两端未锁定的边不跨分区）
+        for (uint32_t u : verts) {
+            if (!alive_[u] || locked_[u]) continue;
+            nbrs.clear();
+            for_each_triangle(u, [&](uint32_t t) {
+                for (uint32_t w : {T_[t].a, T_[t].b, T_[t].c}) if (w > u && !locked_[w]) nbrs.push_back(w);
+            });
+            std::sort(nbrs.begin(), nbrs.end());
+            nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+            for (uint32_t w : nbrs) heap.push_back(make_candidate(u, w));
+        }
+        std::make_heap(heap.begin(), heap.end(), Worse());
+        size_t pushed = 0;
+
+        while (liveTris > target && !heap.empty()) {
+            if (static_cast<double>(pushed) > kHeapPurgeRatio * static_cast<double>(heap.size())) {
+                heap.erase(std::remove_if(heap.begin(), heap.end(), [&](const Candidate &c) { return !fresh(c); }), heap.end());
+                std::make_heap(heap.begin(), heap.end(), Worse());
+                pushed = 0;
+                if (heap.empty()) break;
+            }
+            std::pop_heap(heap.begin(), heap.end(), Worse());
+            const Candidate c = heap.back();
+            heap.pop_back();
+            if (!fresh(c)) continue;
+            MCVertex pos;
+            edge_cost(c.u, c.v, &pos);
+            const size_t removed = collapse(c.u, c.v, pos, scratch);
+            if (removed == 0) continue;
+            liveTris -= std::min(liveTris, removed);
+            for (uint32_t w : nbrs) {
+                if (locked_[w]) continue;
+                heap.push_back(make_candidate(c.u, w));
+                std::push_heap(heap.begin(), heap.end(), Worse());
+                ++pushed;
+            }
+        }
+    }
+
+    // 折叠边 (u, v) 到 pos，v 并入 u；非法（翻面/非流形）时返回 0。
+    // 成功时 s.nbrs 为 u 的新邻接顶点
+    size_t collapse(uint32_t u, uint32_t v, const MCVertex &pos, Scratch &s) {
+        std::vector<uint32_t> &tu = s.tu, &tv = s.tv, &shared = s.shared, &nu = s.nu, &nbrs = s.nbrs;
+        tu.clear(); tv.clear(); shared.clear();
+        for_each_triangle(u, [&](uint32_t t) { tu.push_back(t); });
+        for_each_triangle(v, [&](uint32_t t) {
+            const MCTriangle &tri = T_[t];
+            if (tri.a == u || tri.b == u || tri.c == u) shared.push_back(t);
+            else tv.push_back(t);
+        });
+        if (shared.empty() || shared.size() > 2) return 0;
+        // 两端都在开放边界上的内部边折叠后会把边界捏成非流形顶点
+        if (shared.size() == 2 && border_[u] && border_[v]) return 0;
+
+        // 连接条件：u、v 的公共邻点恰为共享三角形的对顶点
+        nu.clear(); nbrs.clear();
+        for (uint32_t t : tu) for (uint32_t w : {T_[t].a, T_[t].b, T_[t].c}) if (w != u && w != v) nu.push_back(w);
+        for (const auto *list : {&tv, &shared}) {
+            for (uint32_t t : *list) for (uint32_t w : {T_[t].a, T_[t].b, T_[t].c}) if (w != u && w != v) nbrs.push_back(w);
+        }
+        std::sort(nu.begin(), nu.end());
+        nu.erase(std::unique(nu.begin(), nu.end()), nu.end());
+        std::sort(nbrs.begin(), nbrs.end());
+        nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+        size_t common = 0;
+        for (size_t i = 0, j = 0; i < nu.size() && j < nbrs.size();) {
+            if (nu[i] < nbrs[j]) ++i;
+            else if (nbrs[j] < nu[i]) ++j;
+            else { ++common; ++i; ++j; }
+        }
+        if (common != shared.size()) return 0;
+        // 内部边折叠后 u 至少保留 3 个邻点，否则小的闭合分量（如四面体）会退化成背靠背的两个三角形
+        if (shared.size() == 2 && nu.size() + nbrs.size() - common < 3) return 0;
+
+        // 不得留下孤立顶点：共享三角形的对顶点还须有其他三角形，u 也须保留至少一个。
+        // 三角形表只含存活三角形（见下方执行折叠），对顶点不必遍历自己的表
+        if (tu.size() == shared.size() && tv.empty()) return 0;
+        for (uint32_t t : shared) {
+            for (uint32_t w : {T_[t].a, T_[t].b, T_[t].c}) {
+                if (w == u || w == v) continue;
+                uint32_t inShared = 0;
+                for (uint32_t st : shared) {
+                    const MCTriangle &tri = T_[st];
+                    if (tri.a == w || tri.b == w || tri.c == w) ++inShared;
+                }
+                if (adjCount_[w] == inShared) return 0;
+            }
+        }
+
+        // 翻面检查：移动后的三角形法向不得与原法向反向
+        const Vec3d np = to_vec(pos);
+        const auto flips = [&](const std::vector<uint32_t> &tris, uint32_t moved) {
+            for (uint32_t t : tris) {
+                if (std::find(shared.begin(), shared.end(), t) != shared.end()) continue;
+                const MCTriangle &tri = T_[t];
+                const uint32_t ids[3] = {tri.a, tri.b, tri.c};
+                Vec3d before[3], after[3];
+                for (int k = 0; k < 3; ++k) {
+                    before[k] = to_vec(V_[ids[k]]);
+                    after[k] = ids[k] == moved ? np : before[k];
+                }
+                const Vec3d n0 = cross(sub(before[1], before[0]), sub(before[2], before[0]));
+                const Vec3d n1 = cross(sub(after[1], after[0]), sub(after[2], after[0]));
+                if (dot(n0, n0) > 0.0 && !(dot(n0, n1) > 0.0)) return true;
+            }
+            return false;
+        };
+        if (flips(tu, u) || flips(tv, v)) return 0;
+
+        // 执行折叠
+        for (uint32_t t : shared) triAlive_[t] = 0;
+        for (uint32_t t : tv) {
+            MCTriangle &tri = T_[t];
+            if (tri.a == v) tri.a = u;
+            if (tri.b == v) tri.b = u;
+            if (tri.c == v) tri.c = u;
+        }
+        V_[u] = pos;
+        quadrics_[u] += quadrics_[v];
+        if (N_) {
+            MCNormal &a = (*N_)[u];
+            const MCNormal &b = (*N_)[v];
+            const float sx = a.x + b.x, sy = a.y + b.y, sz = a.z + b.z;
+            const float len = std::sqrt(sx * sx + sy * sy + sz * sz);
+            if (len > 0.0f) a = {sx / len, sy / len, sz / len};
+        }
+        alive_[v] = 0;
+        ++stamp_[v];
+        border_[u] = border_[u] | border_[v];
+        // u 的三角形表 = 原表去掉共享三角形 + v 的其余三角形；对顶点的表中删去共享三角形，
+        // 因此各存活顶点的表始终只含存活三角形
+        s.list.clear();
+        for (uint32_t t : tu) if (triAlive_[t]) s.list.push_back(t);
+        s.list.insert(s.list.end(), tv.begin(), tv.end());
+        set_triangles(u, s.list, s);
+        for (uint32_t t : shared) {
+            for (uint32_t w : {T_[t].a, T_[t].b, T_[t].c}) {
+                if (w == u || w == v) continue;
+                uint32_t *tris = adj_[w];
+                uint32_t kept = 0;
+                for (uint32_t i = 0; i < adjCount_[w]; ++i) if (triAlive_[tris[i]]) tris[kept++] = tris[i];
+                adjCount_[w] = kept;
+            }
+        }
+        ++stamp_[u];
+
+        // u 的新邻点 = 原邻点 ∪ v 的邻点
+        nbrs.insert(nbrs.end(), nu.begin(), nu.end());
+        std::sort(nbrs.begin(), nbrs.end());
+        nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+        nbrs.erase(std::remove(nbrs.begin(), nbrs.end(), u), nbrs.end());
+        return shared.size();
+    }
+
+    // 删除已折叠的顶点与三角形，保持存活元素的相对顺序
+    void compact() {
+        std::vector<uint32_t> remap(V_.size(), kNone);
+        size_t nv = 0;
+        for (size_t v = 0; v < V_.size(); ++v) {
+            if (!alive_[v]) continue;
+            remap[v] = static_cast<uint32_t>(nv);
+            V_[nv] = V_[v];
+            if (N_) (*N_)[nv] = (*N_)[v];
+            ++nv;
+        }
+        V_.resize(nv);
+        if (N_) N_->resize(nv);
+        size_t nt = 0;
+        for (size_t t = 0; t < T_.size(); ++t) {
+            if (!triAlive_[t]) continue;
+            const MCTriangle &tri = T_[t];
+            T_[nt++] = {remap[tri.a], remap[tri.b], remap[tri.c]};
+        }
+        T_.resize(nt);
+    }
+
+    std::vector<MCVertex> &V_;
+    std::vector<MCTriangle> &T_;
+    std::vector<MCNormal> *N_;
+
+    std::vector<size_t> csrOffsets_;
+    std::vector<uint32_t> csrTris_;
+    std::vector<Quadric> quadrics_;
+    std::vector<uint8_t> triAlive_, alive_, locked_, border_;
+    std::vector<uint32_t> stamp_;
+    std::vector<uint32_t *> adj_;              // 各顶点当前的三角形表
+    std::vector<uint32_t> adjCount_, adjCap_;
+    std::vector<Scratch> scratch_;
+    std::vector<uint32_t> partOrder_;          // 按分区排列的顶点，分区内按编号
+    std::vector<uint32_t> partBegin_;          // 各分区在 partOrder_ 中的起点
+    std::vector<uint16_t> part_;
+};
+
+} // namespace
+
+void decimate_mesh(std::vector<MCVertex> &vertices,
+                   std::vector<MCTriangle> &triangles,
+                   const MCDecimateOptions &options) {
+    if (options.normals && options.normals->size() != vertices.size()) return;
+    Decimator decimator(vertices, triangles, options.normals);
+    decimator.run(options.targetTriangles, options.numThreads);
+}
@@ -0,0 +1,169 @@
+#include "mesh_smooth.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+// 每个线程至少分到这么多顶点，过小的网格不值得开线程
+constexpr size_t kMinRangeVertices = 16384;
+// 每步按块处理：先把邻点均值收集到目标缓冲，再在同一块上做连续的混合（可向量化）
+constexpr size_t kBlockVertices = 2048;
+
+// 把 [0, n) 均分为若干连续区间并行处理
+template <typename Fn>
+void run_ranges(size_t n, int numThreads, Fn &&fn) {
+    const size_t parts = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(std::max(1, numThreads)),
+                                                              n / kMinRangeVertices + 1));
+    if (parts == 1) { fn(size_t(0), n); return; }
+    std::vector<std::thread> workers;
+    for (size_t p = 0; p < parts; ++p) {
+        workers.emplace_back([&fn, n, parts, p]() { fn(n * p / parts, n * (p + 1) / parts); });
+    }
+    for (auto &w : workers) w.join();
+}
+
+// 顶点邻接 CSR。每个三角形给三个顶点各记两个邻点，一行排序后只出现一次的邻点说明该边
+// 只属于一个三角形，即开放边界边
+struct VertexNeighbours {
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> nbrs;
+    std::vector<uint8_t> border;
+};
+
+void build_neighbours(size_t nv, const std::vector<MCTriangle> &tris, int numThreads, VertexNeighbours &g) {
+    std::vector<size_t> &offsets = g.offsets;
+    offsets.assign(nv + 1, 0);
+    for (const auto &t : tris) { offsets[t.a + 1] += 2; offsets[t.b + 1] += 2; offsets[t.c + 1] += 2; }
+    for (size_t v = 0; v < nv; ++v) offsets[v + 1] += offsets[v];
+    g.nbrs.resize(offsets[nv]);
+    std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto &t : tris) {
+        g.nbrs[cursor[t.a]++] = t.b; g.nbrs[cursor[t.a]++] = t.c;
+        g.nbrs[cursor[t.b]++] = t.c; g.nbrs[cursor[t.b]++] = t.a;
+        g.nbrs[cursor[t.c]++] = t.a; g.nbrs[cursor[t.c]++] = t.b;
+    }
+
+    // 各行排序去重（并行），去重后的行长暂存在 cursor 中
+    g.border.assign(nv, 0);
+    run_ranges(nv, numThreads, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            uint32_t *row = g.nbrs.data() + offsets[v];
+            const size_t n = offsets[v + 1] - offsets[v];
+            std::sort(row, row + n);
+            size_t kept = 0;
+            for (size_t i = 0; i < n;) {
+                size_t j = i + 1;
+                while (j < n && row[j] == row[i]) ++j;
+                if (j - i == 1) g.border[v] = 1;
+                row[kept++] = row[i];
+                i = j;
+            }
+            cursor[v] = kept;
+        }
+    });
+
+    // 压紧：各行左移到新的偏移处（只会向前移动，顺序执行即可）
+    size_t out = 0;
+    for (size_t v = 0; v < nv; ++v) {
+        const size_t begin = offsets[v];
+        offsets[v] = out;
+        std::copy(g.nbrs.begin() + static_cast<std::ptrdiff_t>(begin),
+                  g.nbrs.begin() + static_cast<std::ptrdiff_t>(begin + cursor[v]),
+                  g.nbrs.begin() + static_cast<std::ptrdiff_t>(out));
+        out += cursor[v];
+    }
+    offsets[nv] = out;
+    g.nbrs.resize(out);
+}
+
+// 一步拉普拉斯平滑：dst = src + f * (邻点均值 - src)；边界与孤立顶点取均值为自身，因此保持不变
+void laplacian_step(const VertexNeighbours &g, const float *const src[3], float *const dst[3], float f,
+                    size_t begin, size_t end) {
+    const size_t *offsets = g.offsets.data();
+    const uint32_t *nbrs = g.nbrs.data();
+    for (size_t block = begin; block < end; block += kBlockVertices) {
+        const size_t blockEnd = std::min(block + kBlockVertices, end);
+        for (size_t v = block; v < blockEnd; ++v) {
+            const size_t n = offsets[v + 1] - offsets[v];
+            if (n == 0 || g.border[v]) {
+                dst[0][v] = src[0][v]; dst[1][v] = src[1][v]; dst[2][v] = src[2][v];
+                continue;
+            }
+            float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+            for (size_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+                const uint32_t w = nbrs[i];
+                sx += src[0][w]; sy += src[1][w]; sz += src[2][w];
+            }
+            const float inv = 1.0f / static_cast<float>(n);
+            dst[0][v] = sx * inv; dst[1][v] = sy * inv; dst[2][v] = sz * inv;
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            const float *s = src[axis];
+            float *d = dst[axis];
+            for (size_t v = block; v < blockEnd; ++v) d[v] = s[v] + f * (d[v] - s[v]);
+        }
+    }
+}
+
+// 由平滑后的网格重新计算顶点法向（面积加权面法向之和，方向与三角形绕序一致）
+void recompute_normals(const std::vector<MCVertex> &V, const std::vector<MCTriangle> &T, int numThreads,
+                       std::vector<MCNormal> &normals) {
+    std::vector<MCNormal> sum(V.size(), MCNormal{0.0f, 0.0f, 0.0f});
+    for (const auto &t : T) {
+        const MCVertex &a = V[t.a], &b = V[t.b], &c = V[t.c];
+        const float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        const float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        const float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        for (uint32_t id : {t.a, t.b, t.c}) { sum[id].x += nx; sum[id].y += ny; sum[id].z += nz; }
+    }
+    run_ranges(V.size(), numThreads, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            const MCNormal &s = sum[v];
+            const float len = std::sqrt(s.x * s.x + s.y * s.y + s.z * s.z);
+            if (len > 0.0f) normals[v] = {s.x / len, s.y / len, s.z / len};
+        }
+    });
+}
+
+} // namespace
+
+void smooth_mesh(std::vector<MCVertex> &vertices,
+                 const std::vector<MCTriangle> &triangles,
+                 const MCSmoothOptions &options) {
+    const size_t nv = vertices.size();
+    if (options.iterations <= 0 || nv == 0 || triangles.empty()) return;
+
+    VertexNeighbours g;
+    build_neighbours(nv, triangles, options.numThreads, g);
+
+    // SoA 双缓冲：每步从一组读、向另一组写，步末交换
+    std::vector<float> buffers[2][3];
+    for (auto &set : buffers) for (auto &axis : set) axis.resize(nv);
+    for (size_t v = 0; v < nv; ++v) {
+        buffers[0][0][v] = vertices[v].x; buffers[0][1][v] = vertices[v].y; buffers[0][2][v] = vertices[v].z;
+    }
+
+    int cur = 0;
+    const auto step = [&](float f) {
+        const float *src[3] = {buffers[cur][0].data(), buffers[cur][1].data(), buffers[cur][2].data()};
+        float *dst[3] = {buffers[1 - cur][0].data(), buffers[1 - cur][1].data(), buffers[1 - cur][2].data()};
+        run_ranges(nv, options.numThreads, [&](size_t begin, size_t end) {
+            laplacian_step(g, src, dst, f, begin, end);
+        });
+        cur = 1 - cur;
+    };
+    for (int it = 0; it < options.iterations; ++it) {
+        step(options.lambda);
+        step(options.mu);
+    }
+
+    for (size_t v = 0; v < nv; ++v) {
+        vertices[v] = {buffers[cur][0][v], buffers[cur][1][v], buffers[cur][2][v]};
+    }
+    if (options.normals && options.normals->size() == nv) {
+        recompute_normals(vertices, triangles, options.numThreads, *options.normals);
+    }
+}
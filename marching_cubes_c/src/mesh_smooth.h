@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include "marching_cubes.h"
+
+// Taubin lambda/mu smoothing: every iteration is a uniform Laplacian step with
+// weight lambda followed by one with negative weight mu, which removes the
+// staircase of binary masks without the shrinkage of plain Laplacian smoothing.
+// Vertex neighbours are gathered once into a CSR; each step sweeps SoA
+// coordinate buffers (read one, write the other) split into vertex ranges
+// across threads. Vertices on open borders (the volume boundary) stay fixed.
+struct MCSmoothOptions {
+    int iterations = 0;
+    float lambda = 0.5f;
+    float mu = -0.53f;
+    int numThreads = 1;
+    // Optional per-vertex normals, recomputed from the smoothed surface
+    // (area-weighted face normals) since the volume gradient no longer fits.
+    std::vector<MCNormal> *normals = nullptr;
+};
+
+// Smooth vertex positions in place; connectivity is unchanged.
+void smooth_mesh(std::vector<MCVertex> &vertices,
+                 const std::vector<MCTriangle> &triangles,
+                 const MCSmoothOptions &options);
@@ -0,0 +1,259 @@
+#include "mesh_writers.h"
+#include "chunk_encoder.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+// 小端主机上直接整块写出数组；否则逐元素转为小端
+template <typename T>
+void write_le_array(std::ostream &out, const T *data, size_t count, int numThreads) {
+    static_assert(sizeof(T) % 4 == 0, "array elements must be made of 32-bit words");
+    constexpr size_t kWords = sizeof(T) / 4;
+    if (!host_is_big_endian()) {
+        out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(count * sizeof(T)));
+        return;
+    }
+    write_chunked(out, count, numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        buf.resize((end - begin) * sizeof(T));
+        char *p = buf.data();
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t words[kWords];
+            std::memcpy(words, &data[i], sizeof(T));
+            for (size_t w = 0; w < kWords; ++w) p = put_le32(p, words[w]);
+        }
+    });
+}
+
+// JSON 中的浮点数：最短可往返表示
+std::string json_float(float v) {
+    char buf[32];
+    return std::string(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr);
+}
+
+// glTF 要求 NORMAL 为单位向量。梯度消失处（平坦或饱和区域）的零法向改用相邻三角形的
+// 面法向之和（按面积加权）；仍无法确定的顶点（不属于任何非退化三角形）使整个属性被省略，返回 false
+bool unit_normals(const std::vector<MCVertex> &vertices, const std::vector<MCTriangle> &triangles,
+                  const std::vector<MCNormal> &normals, std::vector<MCNormal> &out) {
+    const auto is_unit = [](const MCNormal &n) {
+        return std::fabs(n.x * n.x + n.y * n.y + n.z * n.z - 1.0f) < 1e-3f;
+    };
+    if (std::all_of(normals.begin(), normals.end(), is_unit)) return true;
+
+    out = normals;
+    std::vector<uint8_t> fix(out.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        fix[i] = is_unit(out[i]) ? 0 : 1;
+        if (fix[i]) out[i] = {0.0f, 0.0f, 0.0f};
+    }
+    for (const auto &t : triangles) {
+        if (!fix[t.a] && !fix[t.b] && !fix[t.c]) continue;
+        const MCVertex &a = vertices[t.a], &b = vertices[t.b], &c = vertices[t.c];
+        const float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        const float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        const MCNormal face = {uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx};
+        for (uint32_t v : {t.a, t.b, t.c}) {
+            if (!fix[v]) continue;
+            out[v].x += face.x; out[v].y += face.y; out[v].z += face.z;
+        }
+    }
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (!fix[i]) continue;
+        MCNormal &n = out[i];
+        const float len = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        if (!(len > 0.0f)) return false;
+        n = {n.x / len, n.y / len, n.z / len};
+    }
+    return true;
+}
+
+template <typename Face>
+bool write_ply(const std::string &path,
+               const std::vector<MCVertex> &vertices,
+               const std::vector<Face> &triangles,
+               std::string &errorMessage,
+               int numThreads,
+               const std::vector<MCNormal> *normals) {
+    constexpr size_t K = kFaceCorners<Face>;
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入PLY文件: " + path; return false; }
+    out << "ply\n";
+    out << "format binary_little_endian 1.0\n";
+    out << "comment marching cubes output\n";
+    out << "element vertex " << vertices.size() << "\n";
+    out << "property float x\n";
+    out << "property float y\n";
+    out << "property float z\n";
+    if (normals) {
+        out << "property float nx\n";
+        out << "property float ny\n";
+        out << "property float nz\n";
+    }
+    out << "element face " << triangles.size() << "\n";
+    out << "property list uchar uint vertex_indices\n";
+    out << "end_header\n";
+
+    if (normals) {
+        // 顶点记录交错存放坐标与法向，共 24 字节
+        write_chunked(out, vertices.size(), numThreads, [&](size_t begin, size_t end, std::string &buf) {
+            buf.resize((end - begin) * 24);
+            char *p = buf.data();
+            for (size_t i = begin; i < end; ++i) {
+                const MCNormal &n = (*normals)[i];
+                p = put_le32(p, vertices[i].x); p = put_le32(p, vertices[i].y); p = put_le32(p, vertices[i].z);
+                p = put_le32(p, n.x); p = put_le32(p, n.y); p = put_le32(p, n.z);
+            }
+        });
+    } else {
+        write_le_array(out, vertices.data(), vertices.size(), numThreads);
+    }
+    // 面记录：uchar 角点数 + K 个 uint32（三角形 13 字节，四边形 17 字节）
+    write_chunked(out, triangles.size(), numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        buf.resize((end - begin) * (1 + 4 * K));
+        char *p = buf.data();
+        for (size_t i = begin; i < end; ++i) {
+            *p++ = static_cast<char>(K);
+            for (uint32_t c : face_corners(triangles[i])) p = put_le32(p, c);
+        }
+    });
+    if (!out) { errorMessage = "写PLY失败: " + path; return false; }
+    return true;
+}
+
+} // namespace
+
+bool write_ply_binary(const std::string &path, const std::vector<MCVertex> &vertices,
+                      const std::vector<MCTriangle> &triangles, std::string &errorMessage,
+                      int numThreads, const std::vector<MCNormal> *normals) {
+    return write_ply(path, vertices, triangles, errorMessage, numThreads, normals);
+}
+
+bool write_ply_binary(const std::string &path, const std::vector<MCVertex> &vertices,
+                      const std::vector<MCQuad> &quads, std::string &errorMessage,
+                      int numThreads, const std::vector<MCNormal> *normals) {
+    return write_ply(path, vertices, quads, errorMessage, numThreads, normals);
+}
+
+bool write_stl_binary(const std::string &path,
+                      const std::vector<MCVertex> &vertices,
+                      const std::vector<MCTriangle> &triangles,
+                      std::string &errorMessage,
+                      int numThreads) {
+    if (triangles.size() > std::numeric_limits<uint32_t>::max()) { errorMessage = "三角形数超出STL上限"; return false; }
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入STL文件: " + path; return false; }
+
+    // 80 字节文件头（不得以 "solid" 开头，否则会被误认为 ASCII STL）+ 三角形数
+    char header[84] = {0};
+    const char title[] = "marching cubes output";
+    std::memcpy(header, title, sizeof(title) - 1);
+    put_le32(header + 80, static_cast<uint32_t>(triangles.size()));
+    out.write(header, sizeof(header));
+
+    // 每个面 50 字节：法向 + 3 个顶点 + uint16 属性
+    write_chunked(out, triangles.size(), numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        buf.resize((end - begin) * 50);
+        char *p = buf.data();
+        for (size_t i = begin; i < end; ++i) {
+            const MCVertex &a = vertices[triangles[i].a];
+            const MCVertex &b = vertices[triangles[i].b];
+            const MCVertex &c = vertices[triangles[i].c];
+            const float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+            const float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+            float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+            const float len = std::sqrt(nx * nx + ny * ny + nz * nz);
+            if (len > 0.0f) { nx /= len; ny /= len; nz /= len; }
+            p = put_le32(p, nx); p = put_le32(p, ny); p = put_le32(p, nz);
+            for (const MCVertex *v : {&a, &b, &c}) {
+                p = put_le32(p, v->x); p = put_le32(p, v->y); p = put_le32(p, v->z);
+            }
+            *p++ = 0; *p++ = 0;
+        }
+    });
+    if (!out) { errorMessage = "写STL失败: " + path; return false; }
+    return true;
+}
+
+bool write_glb(const std::string &path,
+               const std::vector<MCVertex> &vertices,
+               const std::vector<MCTriangle> &triangles,
+               std::string &errorMessage,
+               const std::vector<MCNormal> *normals) {
+    std::vector<MCNormal> fixedNormals;
+    if (normals) {
+        if (!unit_normals(vertices, triangles, *normals, fixedNormals)) normals = nullptr;
+        else if (!fixedNormals.empty()) normals = &fixedNormals;
+    }
+    const uint64_t positionBytes = vertices.size() * sizeof(MCVertex);
+    const uint64_t normalBytes = normals ? normals->size() * sizeof(MCNormal) : 0;
+    const uint64_t indexBytes = triangles.size() * sizeof(MCTriangle);
+    const uint64_t indexOffset = positionBytes + normalBytes;
+    const bool hasMesh = !vertices.empty() && !triangles.empty();
+
+    // JSON：单个 buffer，依次为 POSITION、NORMAL（可选）与 uint32 索引；POSITION 必须给出 min/max
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"marching_cubes_c\"},\"scene\":0,";
+    if (hasMesh) {
+        float mn[3] = {vertices[0].x, vertices[0].y, vertices[0].z};
+        float mx[3] = {mn[0], mn[1], mn[2]};
+        for (const auto &v : vertices) {
+            const float p[3] = {v.x, v.y, v.z};
+            for (int k = 0; k < 3; ++k) { mn[k] = std::min(mn[k], p[k]); mx[k] = std::max(mx[k], p[k]); }
+        }
+        const std::string count = std::to_string(vertices.size());
+        const std::string indexView = normals ? "2" : "1";
+        json += "\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],";
+        json += std::string("\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0") +
+                (normals ? ",\"NORMAL\":1" : "") + "},\"indices\":" + indexView + ",\"mode\":4}]}],";
+        json += "\"buffers\":[{\"byteLength\":" + std::to_string(indexOffset + indexBytes) + "}],";
+        json += "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" + std::to_string(positionBytes) +
+                ",\"target\":34962},";
+        if (normals) {
+            json += "{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes) + ",\"byteLength\":" +
+                    std::to_string(normalBytes) + ",\"target\":34962},";
+        }
+        json += "{\"buffer\":0,\"byteOffset\":" + std::to_string(indexOffset) +
+                ",\"byteLength\":" + std::to_string(indexBytes) + ",\"target\":34963}],";
+        json += "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" + count +
+                ",\"type\":\"VEC3\",\"min\":[" + json_float(mn[0]) + "," + json_float(mn[1]) + "," + json_float(mn[2]) +
+                "],\"max\":[" + json_float(mx[0]) + "," + json_float(mx[1]) + "," + json_float(mx[2]) + "]},";
+        if (normals) json += "{\"bufferView\":1,\"componentType\":5126,\"count\":" + count + ",\"type\":\"VEC3\"},";
+        json += "{\"bufferView\":" + indexView + ",\"componentType\":5125,\"count\":" +
+                std::to_string(triangles.size() * 3) + ",\"type\":\"SCALAR\"}]}";
+    } else {
+        json += "\"scenes\":[{\"nodes\":[]}]}";
+    }
+    json.append((4 - json.size() % 4) % 4, ' ');
+
+    // 数据块长度均为 4 的倍数，无需补齐
+    const uint64_t binBytes = hasMesh ? indexOffset + indexBytes : 0;
+    const uint64_t total = 12 + 8 + json.size() + (hasMesh ? 8 + binBytes : 0);
+    if (total > std::numeric_limits<uint32_t>::max()) { errorMessage = "网格超出GLB 4GB上限"; return false; }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入GLB文件: " + path; return false; }
+    char header[20];
+    char *p = header;
+    std::memcpy(p, "glTF", 4); p += 4;
+    p = put_le32(p, uint32_t(2));
+    p = put_le32(p, static_cast<uint32_t>(total));
+    p = put_le32(p, static_cast<uint32_t>(json.size()));
+    std::memcpy(p, "JSON", 4);
+    out.write(header, sizeof(header));
+    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+    if (hasMesh) {
+        char binHeader[8];
+        put_le32(binHeader, static_cast<uint32_t>(binBytes));
+        std::memcpy(binHeader + 4, "BIN\0", 4);
+        out.write(binHeader, sizeof(binHeader));
+        write_le_array(out, vertices.data(), vertices.size(), 1);
+        if (normals) write_le_array(out, normals->data(), normals->size(), 1);
+        write_le_array(out, triangles.data(), triangles.size(), 1);
+    }
+    if (!out) { errorMessage = "写GLB失败: " + path; return false; }
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "marching_cubes.h"
+
+// Compact binary mesh formats, written straight from the MCVertex/MCTriangle
+// arrays: on little-endian hosts vertex positions (and GLB indices) are written
+// as one block without an intermediate copy; per-face records are encoded in
+// parallel chunks (see chunk_encoder.h).
+
+// Binary little-endian PLY, indexed (float x/y/z, uchar+uint face lists),
+// with triangle or quad faces. Normals, when given, become float nx/ny/nz
+// vertex properties.
+bool write_ply_binary(const std::string &path,
+                      const std::vector<MCVertex> &vertices,
+                      const std::vector<MCTriangle> &triangles,
+                      std::string &errorMessage,
+                      int numThreads = 1,
+                      const std::vector<MCNormal> *normals = nullptr);
+bool write_ply_binary(const std::string &path,
+                      const std::vector<MCVertex> &vertices,
+                      const std::vector<MCQuad> &quads,
+                      std::string &errorMessage,
+                      int numThreads = 1,
+                      const std::vector<MCNormal> *normals = nullptr);
+
+// Binary STL (unindexed, per-face normals from the triangle winding).
+bool write_stl_binary(const std::string &path,
+                      const std::vector<MCVertex> &vertices,
+                      const std::vector<MCTriangle> &triangles,
+                      std::string &errorMessage,
+                      int numThreads = 1);
+
+// glTF 2.0 binary (.glb): one buffer holding POSITION, optional NORMAL, then
+// uint32 indices. glTF requires unit normals: zero normals (vanishing
+// gradient) are replaced by the area-weighted normal of the adjacent faces,
+// and NORMAL is omitted when some vertex has no non-degenerate face.
+bool write_glb(const std::string &path,
+               const std::vector<MCVertex> &vertices,
+               const std::vector<MCTriangle> &triangles,
+               std::string &errorMessage,
+               const std::vector<MCNormal> *normals = nullptr);
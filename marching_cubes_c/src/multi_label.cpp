@@ -0,0 +1,348 @@
+#include "multi_label.h"
+#include "mc_common.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// 多标签提取：一次扫描为每个标签生成 (v == L) 指示体在 0.5 处的等值面。
+// 按行比较相邻体素，8 个角点同属一个标签的单元直接跳过；其余单元对角点中出现的每个
+// 选中标签分别求立方体索引，顶点创建与三角形顺序与 marching_cubes.cpp 的 extract_layer
+// 相同，因此每个标签的网格与对二值化体数据单独提取的结果逐字节一致。
+// 两个标签之间的边同时属于两个标签面，边缓存槽位为两端各存一个顶点编号。
+
+namespace {
+
+// 标签值在计数表中的下标（int16 平移为非负）
+template <typename T>
+inline size_t label_slot(T v) {
+    return static_cast<size_t>(static_cast<int64_t>(v) - static_cast<int64_t>(std::numeric_limits<T>::lowest()));
+}
+
+template <typename T>
+constexpr size_t kLabelSlots = size_t(1) << (8 * sizeof(T));
+
+// 物理边两端按坐标由低到高的角点；标签面在边上的顶点编号按该标签位于哪一端存放
+constexpr int kEdgeLowHigh[12][2] = {
+    {0, 1}, {1, 2}, {3, 2}, {0, 3}, {4, 5}, {5, 6}, {7, 6}, {4, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7},
+};
+
+// 一条边上的两个顶点编号：[0] 属于低端角点的标签面，[1] 属于高端
+struct EdgeIds { uint32_t id[2]; };
+
+// 滑动切片边缓存（同 marching_cubes.cpp 的 EdgeSlices），每个槽位两个编号
+struct LabelEdgeSlices {
+    explicit LabelEdgeSlices(size_t plane) : xLo(plane), xHi(plane), yLo(plane), yHi(plane), z(plane) {}
+
+    void next_layer() {
+        std::swap(xLo, xHi);
+        std::swap(yLo, yHi);
+    }
+
+    std::vector<EdgeIds> xLo, xHi, yLo, yHi, z;
+};
+
+// 引用前一个 slab 所建顶点的三角形角点，键为 (平面偏移 << 2) | (轴 << 1) | 端
+struct LabelPatch {
+    uint32_t output;
+    size_t corner;      // 三角形下标*3 + 角点
+    uint64_t key;
+};
+
+struct LabelSlab {
+    int z0 = 0, z1 = 0;
+    // 第一遍按标签下标计数；确定输出后改为按输出的写入偏移
+    std::vector<size_t> vertexCount, triangleCount;
+    std::vector<size_t> vertexOffset, triangleOffset;
+    std::vector<LabelPatch> patches;
+    std::vector<EdgeIds> xTop, yTop;
+};
+
+// 逐行找出角点标签不全相同的单元，并对其中每个选中的标签回调 fn(x, 角点标签, 标签, 立方体索引)
+template <typename T>
+class LabelRows {
+public:
+    LabelRows(const T *vol, int nx, int ny, const std::vector<uint8_t> &selected)
+        : vol_(vol), nx_(static_cast<size_t>(nx)), plane_(nx_ * static_cast<size_t>(ny)), selected_(selected),
+          mixed_((nx_ - 1 + 7) / 8 * 8, 0) {}
+
+    template <typename Fn>
+    void for_each_cell_label(int y, int z, Fn &&fn) {
+        const T *a = vol_ + static_cast<size_t>(z) * plane_ + static_cast<size_t>(y) * nx_;
+        const T *b = a + nx_, *c = a + plane_, *d = c + nx_;
+        const size_t cells = nx_ - 1;
+        uint8_t *m = mixed_.data();
+        // 角点 0 与其余 7 个角点逐一比较（连续访问，可向量化）
+        for (size_t x = 0; x < cells; ++x) {
+            const T v = a[x];
+            m[x] = static_cast<uint8_t>((a[x + 1] != v) | (b[x] != v) | (b[x + 1] != v) | (c[x] != v) |
+                                        (c[x + 1] != v) | (d[x] != v) | (d[x + 1] != v));
+        }
+        // 每次检查 8 个单元，全部同标签时直接跳过
+        for (size_t x0 = 0; x0 < cells; x0 += 8) {
+            uint64_t any;
+            std::memcpy(&any, m + x0, sizeof(any));
+            if (!any) continue;
+            const size_t x1 = std::min(x0 + 8, cells);
+            for (size_t x = x0; x < x1; ++x) {
+                if (!m[x]) continue;
+                const T lab[8] = {a[x], a[x + 1], b[x + 1], b[x], c[x], c[x + 1], d[x + 1], d[x]};
+                for (int i = 0; i < 8; ++i) {
+                    const T label = lab[i];
+                    bool seen = false;
+                    for (int j = 0; j < i; ++j) seen = seen || lab[j] == label;
+                    if (seen || !selected_[label_slot(label)]) continue;
+                    int cube = 0;
+                    for (int k = 0; k < 8; ++k) cube |= (lab[k] != label ? 1 : 0) << k;
+                    fn(static_cast<int>(x), lab, label, cube);
+                }
+            }
+        }
+    }
+
+private:
+    const T *vol_;
+    size_t nx_, plane_;
+    const std::vector<uint8_t> &selected_;
+    std::vector<uint8_t> mixed_;    // 补齐到 8 的倍数，补齐部分保持为 0
+};
+
+template <typename T>
+class MultiLabelExtractor {
+public:
+    MultiLabelExtractor(const T *vol, int nx, int ny, int nz) : vol_(vol), nx_(nx), ny_(ny), nz_(nz) {}
+
+    void run(const MCLabelOptions &options, std::vector<MCLabelSurface> &out) {
+        // 选中的标签：给定列表（表示范围外的值不会出现），或除 0 以外的全部标签
+        selected_.assign(kLabelSlots<T>, 0);
+        const bool all = options.labels.empty();
+        if (all) {
+            std::fill(selected_.begin(), selected_.end(), 1);
+            selected_[label_slot(T(0))] = 0;
+        } else {
+            for (int label : options.labels) {
+                if (representable(label)) selected_[label_slot(static_cast<T>(label))] = 1;
+            }
+        }
+
+        // 按单元层均分为 z-slab
+        const int layers = nz_ - 1;
+        const int numSlabs = std::max(1, std::min(options.numThreads, layers));
+        std::vector<LabelSlab> slabs(static_cast<size_t>(numSlabs));
+        for (int s = 0; s < numSlabs; ++s) {
+            slabs[static_cast<size_t>(s)].z0 = static_cast<int>(static_cast<int64_t>(layers) * s / numSlabs);
+            slabs[static_cast<size_t>(s)].z1 = static_cast<int>(static_cast<int64_t>(layers) * (s + 1) / numSlabs);
+        }
+
+        // 第一遍：按标签计数
+        parallel_for(numSlabs, numSlabs, [&](int s) { count_slab(slabs[static_cast<size_t>(s)]); });
+
+        // 输出顺序：给定列表的顺序（重复的标签只保留第一次），或按标签值递增的有表面的标签
+        out.clear();
+        outputOf_.assign(kLabelSlots<T>, -1);
+        const auto add_output = [&](int label, bool matchable) {
+            if (matchable) outputOf_[label_slot(static_cast<T>(label))] = static_cast<int>(out.size());
+            out.emplace_back();
+            out.back().label = label;
+        };
+        if (all) {
+            for (size_t slot = 0; slot < kLabelSlots<T>; ++slot) {
+                size_t triangles = 0;
+                for (const auto &slab : slabs) triangles += slab.triangleCount[slot];
+                if (triangles == 0) continue;
+                add_output(static_cast<int>(static_cast<int64_t>(slot) + std::numeric_limits<T>::lowest()), true);
+            }
+        } else {
+            for (int label : options.labels) {
+                const bool known = representable(label);
+                if (known && outputOf_[label_slot(static_cast<T>(label))] >= 0) continue;
+                add_output(label, known);
+            }
+        }
+
+        // 各输出的顶点/三角形偏移前缀和
+        const size_t outputs = out.size();
+        std::vector<size_t> vertices(outputs, 0), triangles(outputs, 0);
+        for (auto &slab : slabs) {
+            slab.vertexOffset.assign(outputs, 0);
+            slab.triangleOffset.assign(outputs, 0);
+            for (size_t o = 0; o < outputs; ++o) {
+                if (!representable(out[o].label)) continue;
+                const size_t slot = label_slot(static_cast<T>(out[o].label));
+                slab.vertexOffset[o] = vertices[o];
+                slab.triangleOffset[o] = triangles[o];
+                vertices[o] += slab.vertexCount[slot];
+                triangles[o] += slab.triangleCount[slot];
+            }
+        }
+        for (size_t o = 0; o < outputs; ++o) {
+            out[o].vertices.resize(vertices[o]);
+            out[o].triangles.resize(triangles[o]);
+            if (options.normals) out[o].normals.resize(vertices[o]);
+        }
+        // 第一遍只统计选中的标签；未输出的标签不再处理
+        for (size_t slot = 0; slot < kLabelSlots<T>; ++slot) selected_[slot] = outputOf_[slot] >= 0 ? 1 : 0;
+
+        // 第二遍：各 slab 写入各自的区间
+        surfaces_ = out.data();
+        withNormals_ = options.normals;
+        parallel_for(numSlabs, numSlabs, [&](int s) { fill_slab(slabs[static_cast<size_t>(s)]); });
+
+        // 回填 slab 边界：外部引用取前一个 slab 上平面缓存中对应端的编号
+        parallel_for(numSlabs, numSlabs, [&](int si) {
+            const size_t s = static_cast<size_t>(si);
+            for (const auto &patch : slabs[s].patches) {
+                const LabelSlab &prev = slabs[s - 1];
+                const size_t pos = static_cast<size_t>(patch.key >> 2);
+                const EdgeIds &ids = (patch.key & 2) ? prev.yTop[pos] : prev.xTop[pos];
+                const uint32_t vertex = ids.id[patch.key & 1];
+                MCTriangle &tri = out[patch.output].triangles[patch.corner / 3];
+                switch (patch.corner % 3) {
+                    case 0: tri.a = vertex; break;
+                    case 1: tri.b = vertex; break;
+                    default: tri.c = vertex; break;
+                }
+            }
+        });
+    }
+
+private:
+    static bool representable(int label) {
+        return label >= static_cast<int>(std::numeric_limits<T>::lowest()) &&
+               label <= static_cast<int>(std::numeric_limits<T>::max());
+    }
+
+    void count_slab(LabelSlab &task) const {
+        const TriangleCountTable &triCount = triangle_counts();
+        task.vertexCount.assign(kLabelSlots<T>, 0);
+        task.triangleCount.assign(kLabelSlots<T>, 0);
+        LabelRows<T> rows(vol_, nx_, ny_, selected_);
+        for (int z = task.z0; z < task.z1; ++z) {
+            // slab 首层且 z0>0 时下平面的边 (0..3) 属于前一个 slab
+            const int lowerMask = (z == task.z0 && task.z0 > 0) ? ~0xF : ~0;
+            for (int y = 0; y < ny_ - 1; ++y) {
+                rows.for_each_cell_label(y, z, [&](int x, const T *, T label, int cube) {
+                    const int edges = edgeTable[cube] & owned_edge_mask(x, y, z) & lowerMask;
+                    const size_t slot = label_slot(label);
+                    task.vertexCount[slot] += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(edges)));
+                    task.triangleCount[slot] += triCount.count[cube];
+                });
+            }
+        }
+    }
+
+    void fill_slab(LabelSlab &task) const {
+        const size_t plane = static_cast<size_t>(nx_) * static_cast<size_t>(ny_);
+        std::vector<size_t> nextVertex = task.vertexOffset, nextTriangle = task.triangleOffset;
+        task.patches.clear();
+        LabelEdgeSlices slices(plane);
+        LabelRows<T> rows(vol_, nx_, ny_, selected_);
+
+        for (int z = task.z0; z < task.z1; ++z) {
+            const bool lowerExternal = z == task.z0 && task.z0 > 0;
+            for (int y = 0; y < ny_ - 1; ++y) {
+                rows.for_each_cell_label(y, z, [&](int x, const T *lab, T label, int cube) {
+                    const size_t c00 = static_cast<size_t>(y) * static_cast<size_t>(nx_) + static_cast<size_t>(x);
+                    const size_t c10 = c00 + 1, c01 = c00 + static_cast<size_t>(nx_), c11 = c01 + 1;
+                    EdgeIds *const slot[12] = {
+                        &slices.xLo[c00], &slices.yLo[c10], &slices.xLo[c01], &slices.yLo[c00],
+                        &slices.xHi[c00], &slices.yHi[c10], &slices.xHi[c01], &slices.yHi[c00],
+                        &slices.z[c00],   &slices.z[c10],   &slices.z[c11],   &slices.z[c01],
+                    };
+                    // 外部下平面边 0..3 的偏移与轴（同 extract_layer）
+                    const uint64_t externalKey[4] = {
+                        (static_cast<uint64_t>(c00) << 2) | 0, (static_cast<uint64_t>(c10) << 2) | 2,
+                        (static_cast<uint64_t>(c01) << 2) | 0, (static_cast<uint64_t>(c00) << 2) | 2,
+                    };
+
+                    const size_t output = static_cast<size_t>(outputOf_[label_slot(label)]);
+                    MCLabelSurface &surface = surfaces_[output];
+                    float val[8];
+                    for (int k = 0; k < 8; ++k) val[k] = lab[k] == label ? 1.0f : 0.0f;
+                    const float fx = static_cast<float>(x), fy = static_cast<float>(y), fz = static_cast<float>(z);
+                    const EdgeVertex p[8] = {
+                        {fx, fy, fz}, {fx + 1, fy, fz}, {fx + 1, fy + 1, fz}, {fx, fy + 1, fz},
+                        {fx, fy, fz + 1}, {fx + 1, fy, fz + 1}, {fx + 1, fy + 1, fz + 1}, {fx, fy + 1, fz + 1},
+                    };
+
+                    // 物理边按 0..11 的顺序创建或读取顶点，与 extract_layer 的创建顺序一致
+                    const int edges = edgeTable[cube];
+                    const int owned = owned_edge_mask(x, y, z);
+                    uint32_t vertIndices[12] = {0};
+                    int side[12] = {0};
+                    for (int e = 0; e < 12; ++e) {
+                        if (!(edges & (1 << e))) continue;
+                        side[e] = lab[kEdgeLowHigh[e][1]] == label ? 1 : 0;
+                        if (e < 4 && lowerExternal) continue;
+                        if (owned & (1 << e)) {
+                            const int i1 = kEdgeCorners[e][0], i2 = kEdgeCorners[e][1];
+                            const uint32_t id = static_cast<uint32_t>(nextVertex[output]++);
+                            const EdgeVertex v = vertex_lerp(0.5f, p[i1], p[i2], val[i1], val[i2]);
+                            surface.vertices[id] = {v.x, v.y, v.z};
+                            if (withNormals_) {
+                                surface.normals[id] = field_edge_normal(
+                                    vol_, nx_, ny_, nz_, [label](T s) { return s == label ? 1.0f : 0.0f; },
+                                    0.5f, p[i1], p[i2], val[i1], val[i2]);
+                            }
+                            slot[e]->id[side[e]] = id;
+                        }
+                        vertIndices[e] = slot[e]->id[side[e]];
+                    }
+
+                    const int *tri = triTable[cube];
+                    for (int i = 0; i + 2 < 16 && tri[i] != -1 && tri[i + 1] != -1 && tri[i + 2] != -1; i += 3) {
+                        const size_t t = nextTriangle[output]++;
+                        const int e[3] = {edge_index_map[tri[i]], edge_index_map[tri[i + 1]],
+                                          edge_index_map[tri[i + 2]]};
+                        // 外部边先写占位，合并后回填
+                        if (lowerExternal) {
+                            for (int k = 0; k < 3; ++k) {
+                                if (e[k] < 4) {
+                                    task.patches.push_back({static_cast<uint32_t>(output), t * 3 + static_cast<size_t>(k),
+                                                            externalKey[e[k]] | static_cast<uint64_t>(side[e[k]])});
+                                }
+                            }
+                        }
+                        surface.triangles[t] = {vertIndices[e[0]], vertIndices[e[1]], vertIndices[e[2]]};
+                    }
+                });
+            }
+            slices.next_layer();
+        }
+
+        // 最后一次交换后 lo 即为上平面 z1
+        task.xTop = std::move(slices.xLo);
+        task.yTop = std::move(slices.yLo);
+    }
+
+    const T *vol_;
+    int nx_, ny_, nz_;
+    std::vector<uint8_t> selected_;
+    std::vector<int> outputOf_;
+    MCLabelSurface *surfaces_ = nullptr;
+    bool withNormals_ = false;
+};
+
+} // namespace
+
+template <typename T>
+void marching_cubes_labels(const T *vol, int nx, int ny, int nz, const MCLabelOptions &options,
+                           std::vector<MCLabelSurface> &out) {
+    out.clear();
+    if (nx < 2 || ny < 2 || nz < 2) {
+        for (int label : options.labels) {
+            out.emplace_back();
+            out.back().label = label;
+        }
+        return;
+    }
+    MultiLabelExtractor<T> extractor(vol, nx, ny, nz);
+    extractor.run(options, out);
+}
+
+template void marching_cubes_labels<uint8_t>(const uint8_t *, int, int, int, const MCLabelOptions &,
+                                             std::vector<MCLabelSurface> &);
+template void marching_cubes_labels<int16_t>(const int16_t *, int, int, int, const MCLabelOptions &,
+                                             std::vector<MCLabelSurface> &);
+template void marching_cubes_labels<uint16_t>(const uint16_t *, int, int, int, const MCLabelOptions &,
+                                              std::vector<MCLabelSurface> &);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "marching_cubes.h"
+
+// Surface of one label of a label volume.
+struct MCLabelSurface {
+    int label = 0;
+    std::vector<MCVertex> vertices;
+    std::vector<MCTriangle> triangles;
+    std::vector<MCNormal> normals;      // one per vertex when MCLabelOptions::normals is set
+};
+
+struct MCLabelOptions {
+    // Labels to extract, in output order. Empty: every label other than 0 that
+    // has a surface, ascending.
+    std::vector<int> labels;
+    // > 1 splits the volume into z-slabs extracted in parallel; the output is
+    // byte-identical for every thread count.
+    int numThreads = 1;
+    // Gradient normals of each label's indicator volume.
+    bool normals = false;
+};
+
+// One surface per label, extracted in a single sweep. The surface of label L is
+// the 0.5 isosurface of the indicator volume (v == L), so vertices sit at edge
+// midpoints and each mesh is the one marching_cubes() produces for that
+// binarised volume. An edge between two labels carries one vertex for each of
+// them at the same position, so neighbouring surfaces meet exactly. Cells whose
+// eight corners share one label are rejected by a row-wise comparison; the rest
+// are classified against each selected label among their corners, so the cost
+// barely depends on the number of labels.
+// Instantiated for uint8_t, int16_t and uint16_t voxels.
+template <typename T>
+void marching_cubes_labels(const T *volume, int nx, int ny, int nz,
+                           const MCLabelOptions &options,
+                           std::vector<MCLabelSurface> &out);
@@ -1,10 +1,21 @@
 #include "npy_reader.h"
 
+#include <algorithm>
 #include <fstream>
+#include <istream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <cstring>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NPY_HAVE_MMAP 1
+#endif
+
 static bool parse_npy_header(std::istream &in, NpyInfo &info, size_t &dataOffset, std::string &err) {
     // Magic string: \x93NUMPY
     char magic[6];
@@ -90,12 +101,240 @@ static bool parse_npy_header(std::istream &in, NpyInfo &info, size_t &dataOffset
     info.shape = parse_shape_tuple(find_key("shape"));
 
     if (info.shape.empty()) { err = "shape为空"; return false; }
-    if (info.fortranOrder) { err = "暂不支持Fortran顺序NPY"; return false; }
 
     dataOffset = static_cast<size_t>(in.tellg());
     return true;
 }
 
+// 只读内存流：让 parse_npy_header 直接解析映射区的头部
+namespace {
+struct MemoryBuf : std::streambuf {
+    MemoryBuf(const char *data, size_t size) {
+        char *p = const_cast<char *>(data);
+        setg(p, p, p + size);
+    }
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+        if (dir != std::ios_base::cur || off != 0) return pos_type(off_type(-1));
+        return pos_type(static_cast<off_type>(gptr() - eback()));
+    }
+};
+
+bool host_is_little_endian() {
+    const uint16_t probe = 1;
+    uint8_t first = 0;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// 由 descr 解析 dtype 与是否需要字节交换
+// descr 须为可选的字节序前缀（< > | = !）加类型码，整串匹配（"<f4x"、"<c16" 等不接受）
+bool parse_dtype(const std::string &descr, NpyDType &dtype, bool &needSwap, std::string &err) {
+    const char order = descr.empty() ? '\0' : descr[0];
+    const bool hasOrder = order == '<' || order == '>' || order == '|' || order == '=' || order == '!';
+    const std::string code = hasOrder ? descr.substr(1) : descr;
+    if (code == "f4") dtype = NpyDType::F4;
+    else if (code == "i2") dtype = NpyDType::I2;
+    else if (code == "u2") dtype = NpyDType::U2;
+    else if (code == "i4") dtype = NpyDType::I4;
+    else if (code == "u1") dtype = NpyDType::U1;
+    else { err = "不支持的dtype: " + descr; return false; }
+    const bool bigEndian = order == '>' || order == '!' || (order == '=' && !host_is_little_endian());
+    needSwap = npy_dtype_size(dtype) > 1 && bigEndian == host_is_little_endian();
+    return true;
+}
+
+// 各维尺寸之积；溢出 size_t 时返回 false（构造的头部可使乘积回绕，绕过文件大小检查）
+bool element_count(const std::vector<size_t> &shape, size_t &count, std::string &err) {
+    count = 1;
+    for (size_t d : shape) {
+        if (d != 0 && count > std::numeric_limits<size_t>::max() / d) { err = "NPY形状过大"; return false; }
+        count *= d;
+    }
+    return true;
+}
+
+void swap_elements(char *data, size_t n, size_t elemSize) {
+    for (size_t i = 0; i < n; ++i) std::reverse(data + i * elemSize, data + (i + 1) * elemSize);
+}
+} // namespace
+
+size_t npy_dtype_size(NpyDType dtype) {
+    switch (dtype) {
+        case NpyDType::U1: return 1;
+        case NpyDType::I2: case NpyDType::U2: return 2;
+        case NpyDType::F4: case NpyDType::I4: return 4;
+    }
+    return 0;
+}
+
+NpyView::~NpyView() { close(); }
+
+NpyView::NpyView(NpyView &&other) noexcept { *this = std::move(other); }
+
+NpyView &NpyView::operator=(NpyView &&other) noexcept {
+    if (this != &other) {
+        close();
+        info_ = std::move(other.info_);
+        dtype_ = other.dtype_;
+        count_ = other.count_;
+        data_ = other.data_;
+        map_ = other.map_;
+        mapSize_ = other.mapSize_;
+        owned_ = std::move(other.owned_);
+        fileCopy_ = std::move(other.fileCopy_);   // data_ 可能指向其中（无 mmap 时）
+        other.data_ = nullptr;
+        other.map_ = nullptr;
+        other.mapSize_ = 0;
+        other.count_ = 0;
+    }
+    return *this;
+}
+
+void NpyView::close() {
+#if defined(NPY_HAVE_MMAP)
+    if (map_) munmap(map_, mapSize_);
+#endif
+    map_ = nullptr;
+    mapSize_ = 0;
+    data_ = nullptr;
+    count_ = 0;
+    owned_.clear();
+    owned_.shrink_to_fit();
+    fileCopy_.clear();
+    fileCopy_.shrink_to_fit();
+}
+
+size_t NpyView::element_size() const { return npy_dtype_size(dtype_); }
+
+bool NpyView::open(const std::string &path, std::string &errorMessage) {
+    close();
+
+    // 1. 映射整个文件（无 mmap 时退回一次性读入）
+    const char *base = nullptr;
+    size_t fileSize = 0;
+#if defined(NPY_HAVE_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { errorMessage = "无法打开文件: " + path; return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); errorMessage = "无法获取文件大小: " + path; return false; }
+    fileSize = static_cast<size_t>(st.st_size);
+    void *m = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m != MAP_FAILED) {
+        map_ = m;
+        mapSize_ = fileSize;
+        madvise(map_, mapSize_, MADV_SEQUENTIAL);
+        base = static_cast<const char *>(map_);
+    }
+#endif
+    if (!base) {
+        std::ifstream fin(path, std::ios::binary | std::ios::ate);
+        if (!fin) { errorMessage = "无法打开文件: " + path; return false; }
+        fileSize = static_cast<size_t>(fin.tellg());
+        fileCopy_.resize(fileSize);
+        fin.seekg(0, std::ios::beg);
+        if (!fin.read(fileCopy_.data(), static_cast<std::streamsize>(fileSize))) { errorMessage = "读取数据失败"; return false; }
+        base = fileCopy_.data();
+    }
+
+    // 2. 解析头部
+    MemoryBuf buf(base, fileSize);
+    std::istream in(&buf);
+    size_t offset = 0;
+    if (!parse_npy_header(in, info_, offset, errorMessage)) { close(); return false; }
+
+    // dtype
+    bool needSwap = false;
+    if (!parse_dtype(info_.descr, dtype_, needSwap, errorMessage)) { close(); return false; }
+    const size_t elemSize = element_size();
+
+    // total count
+    size_t count = 0;
+    if (!element_count(info_.shape, count, errorMessage)) { close(); return false; }
+    if (offset > fileSize || count > (fileSize - offset) / elemSize) { errorMessage = "读取数据失败"; close(); return false; }
+    count_ = count;
+    const char *src = base + offset;
+
+    // 3. 常见情况（小端、C 顺序、对齐）直接暴露映射区，无任何拷贝
+    const bool aligned = reinterpret_cast<uintptr_t>(src) % elemSize == 0;
+    if (!needSwap && !info_.fortranOrder && aligned) {
+        data_ = src;
+        return true;
+    }
+
+    // 4. 其余情况转换为本机字节序的 C 顺序副本
+    owned_.resize(count * elemSize);
+    const std::vector<size_t> &shape = info_.shape;
+    const size_t ndim = shape.size();
+    const auto copy_element = [&](size_t dstIndex, size_t srcIndex) {
+        const char *s = src + srcIndex * elemSize;
+        char *d = owned_.data() + dstIndex * elemSize;
+        if (needSwap) {
+            for (size_t b = 0; b < elemSize; ++b) d[b] = s[elemSize - 1 - b];
+        } else {
+            std::memcpy(d, s, elemSize);
+        }
+    };
+    if (!info_.fortranOrder || ndim < 2) {
+        for (size_t i = 0; i < count; ++i) copy_element(i, i);
+    } else {
+        // Fortran 顺序：第 k 维步长为前 k 维尺寸之积；按 C 顺序输出逐元素收集
+        std::vector<size_t> stride(ndim, 1), pos(ndim, 0);
+        for (size_t k = 1; k < ndim; ++k) stride[k] = stride[k - 1] * shape[k - 1];
+        size_t srcIndex = 0;
+        for (size_t i = 0; i < count; ++i) {
+            copy_element(i, srcIndex);
+            for (size_t k = ndim; k-- > 0;) {
+                if (++pos[k] < shape[k]) { srcIndex += stride[k]; break; }
+                srcIndex -= (shape[k] - 1) * stride[k];
+                pos[k] = 0;
+            }
+        }
+    }
+    info_.fortranOrder = false;
+    data_ = owned_.data();
+
+    // 转换完成后不再需要原始映射
+#if defined(NPY_HAVE_MMAP)
+    if (map_) { munmap(map_, mapSize_); map_ = nullptr; mapSize_ = 0; }
+#endif
+    fileCopy_.clear();
+    fileCopy_.shrink_to_fit();
+    return true;
+}
+
+bool NpyStreamReader::open(const std::string &path, std::string &errorMessage) {
+    in_.close();
+    in_.clear();
+    in_.open(path, std::ios::binary);
+    if (!in_) { errorMessage = "无法打开文件: " + path; return false; }
+    if (!parse_npy_header(in_, info_, dataOffset_, errorMessage)) return false;
+    if (info_.fortranOrder) { errorMessage = "流式读取不支持Fortran顺序NPY"; return false; }
+    if (!parse_dtype(info_.descr, dtype_, swap_, errorMessage)) return false;
+
+    size_t count = 0;
+    if (!element_count(info_.shape, count, errorMessage)) return false;
+    in_.seekg(0, std::ios::end);
+    const size_t fileSize = static_cast<size_t>(in_.tellg());
+    if (dataOffset_ > fileSize || count > (fileSize - dataOffset_) / npy_dtype_size(dtype_)) {
+        errorMessage = "读取数据失败"; return false;
+    }
+    count_ = count;
+    return true;
+}
+
+bool NpyStreamReader::read(size_t first, size_t n, void *dst, std::string &errorMessage) {
+    if (first > count_ || n > count_ - first) { errorMessage = "读取范围越界"; return false; }
+    const size_t elemSize = npy_dtype_size(dtype_);
+    in_.clear();
+    in_.seekg(static_cast<std::streamoff>(dataOffset_ + first * elemSize), std::ios::beg);
+    if (!in_.read(static_cast<char *>(dst), static_cast<std::streamsize>(n * elemSize))) {
+        errorMessage = "读取数据失败"; return false;
+    }
+    if (swap_) swap_elements(static_cast<char *>(dst), n, elemSize);
+    return true;
+}
+
 template <typename SrcT>
 static void convert_to_float(const SrcT *src, size_t count, std::vector<float> &dst) {
     dst.resize(count);
@@ -106,61 +345,29 @@ bool load_npy_to_float(const std::string &path,
                        std::vector<size_t> &shapeOut,
                        std::vector<float> &dataOut,
                        std::string &errorMessage) {
-    std::ifstream fin(path, std::ios::binary);
-    if (!fin) { errorMessage = "无法打开文件: " + path; return false; }
-    NpyInfo info;
-    size_t offset=0;
-    if (!parse_npy_header(fin, info, offset, errorMessage)) return false;
-
-    // dtype
-    size_t elemSize = 0;
-    enum class DType { F4, I2, I4, U1 };
-    DType dt;
-    bool bigEndian = false;
-    if (!info.descr.empty() && (info.descr[0] == '>' || info.descr[0] == '!' )) bigEndian = true; // big-endian
-    if (info.descr.find("f4") != std::string::npos) { elemSize=4; dt=DType::F4; }
-    else if (info.descr.find("i2") != std::string::npos) { elemSize=2; dt=DType::I2; }
-    else if (info.descr.find("i4") != std::string::npos) { elemSize=4; dt=DType::I4; }
-    else if (info.descr.find("u1") != std::string::npos) { elemSize=1; dt=DType::U1; }
-    else { errorMessage = "不支持的dtype: " + info.descr; return false; }
+    NpyView view;
+    if (!view.open(path, errorMessage)) return false;
 
-    // total count
-    size_t count = 1;
-    for (size_t d : info.shape) count *= d;
-
-    // read raw
-    fin.seekg(offset, std::ios::beg);
-    std::vector<char> raw(count * elemSize);
-    if (!fin.read(raw.data(), raw.size())) { errorMessage = "读取数据失败"; return false; }
-
-    // If big-endian, byteswap to little-endian
-    if (bigEndian && elemSize > 1) {
-        for (size_t i=0; i<raw.size(); i += elemSize) {
-            for (size_t a=0, b=elemSize-1; a<b; ++a, --b) {
-                std::swap(raw[i+a], raw[i+b]);
-            }
-        }
-    }
-
-    // Convert to float assuming native little-endian host
+    // 直接从映射区单遍转换，不再额外读入原始字节
     dataOut.clear();
-    switch (dt) {
-        case DType::F4:
-            convert_to_float(reinterpret_cast<const float*>(raw.data()), count, dataOut);
+    switch (view.dtype()) {
+        case NpyDType::F4:
+            convert_to_float(view.as<float>(), view.count(), dataOut);
+            break;
+        case NpyDType::I2:
+            convert_to_float(view.as<int16_t>(), view.count(), dataOut);
             break;
-        case DType::I2:
-            convert_to_float(reinterpret_cast<const int16_t*>(raw.data()), count, dataOut);
+        case NpyDType::U2:
+            convert_to_float(view.as<uint16_t>(), view.count(), dataOut);
             break;
-        case DType::I4:
-            convert_to_float(reinterpret_cast<const int32_t*>(raw.data()), count, dataOut);
+        case NpyDType::I4:
+            convert_to_float(view.as<int32_t>(), view.count(), dataOut);
             break;
-        case DType::U1:
-            convert_to_float(reinterpret_cast<const uint8_t*>(raw.data()), count, dataOut);
+        case NpyDType::U1:
+            convert_to_float(view.as<uint8_t>(), view.count(), dataOut);
             break;
     }
 
-    shapeOut = info.shape;
+    shapeOut = view.shape();
     return true;
 }
-
-
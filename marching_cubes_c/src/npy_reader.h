@@ -2,11 +2,13 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <fstream>
 #include <string>
 #include <vector>
 
-// Minimal NPY loader supporting C-order arrays and dtypes: float32, int16, int32, uint8
-// Converts data to float32 output for marching cubes.
+// Minimal NPY loader supporting dtypes: float32, int16, uint16, int32, uint8
+// NpyView memory-maps the file and exposes the array in place; load_npy_to_float
+// converts to a float32 copy for callers that need one.
 
 struct NpyInfo {
     std::vector<size_t> shape; // e.g., {1, Z, Y, X}
@@ -20,3 +22,79 @@ bool load_npy_to_float(const std::string &path,
                        std::string &errorMessage);
 
 
+enum class NpyDType { F4, I2, U2, I4, U1 };
+
+template <typename T> struct NpyDTypeOf;
+template <> struct NpyDTypeOf<float>    { static constexpr NpyDType value = NpyDType::F4; };
+template <> struct NpyDTypeOf<int16_t>  { static constexpr NpyDType value = NpyDType::I2; };
+template <> struct NpyDTypeOf<uint16_t> { static constexpr NpyDType value = NpyDType::U2; };
+template <> struct NpyDTypeOf<int32_t>  { static constexpr NpyDType value = NpyDType::I4; };
+template <> struct NpyDTypeOf<uint8_t>  { static constexpr NpyDType value = NpyDType::U1; };
+
+// Bytes per element of an NPY dtype.
+size_t npy_dtype_size(NpyDType dtype);
+
+// Read-only, zero-copy view of an NPY file.
+// Little-endian C-order data is served straight from the mapping, so opening a
+// file costs only the page faults of what is later read. Big-endian or
+// Fortran-order files are converted once into an owned native C-order buffer.
+class NpyView {
+public:
+    NpyView() = default;
+    ~NpyView();
+    NpyView(const NpyView &) = delete;
+    NpyView &operator=(const NpyView &) = delete;
+    NpyView(NpyView &&other) noexcept;
+    NpyView &operator=(NpyView &&other) noexcept;
+
+    bool open(const std::string &path, std::string &errorMessage);
+    void close();
+
+    const NpyInfo &info() const { return info_; }
+    const std::vector<size_t> &shape() const { return info_.shape; }
+    NpyDType dtype() const { return dtype_; }
+    size_t element_size() const;
+    size_t count() const { return count_; }
+    // True when the data had to be converted into an owned buffer.
+    bool converted() const { return !owned_.empty(); }
+    const void *data() const { return data_; }
+
+    // Typed span of count() elements, or nullptr when T does not match dtype().
+    template <typename T>
+    const T *as() const {
+        return dtype_ == NpyDTypeOf<T>::value ? static_cast<const T *>(data_) : nullptr;
+    }
+
+private:
+    NpyInfo info_;
+    NpyDType dtype_ = NpyDType::F4;
+    size_t count_ = 0;
+    const void *data_ = nullptr;
+    void *map_ = nullptr;
+    size_t mapSize_ = 0;
+    std::vector<char> owned_;     // converted data (big-endian / Fortran order)
+    std::vector<char> fileCopy_;  // whole file when mmap is unavailable
+};
+
+// Reads element ranges (e.g. one z-plane) of an NPY file on demand, in native
+// byte order, for volumes that are too large to map or load at once. Only
+// C-order files can be read plane by plane; Fortran-order files are rejected.
+class NpyStreamReader {
+public:
+    bool open(const std::string &path, std::string &errorMessage);
+
+    const std::vector<size_t> &shape() const { return info_.shape; }
+    NpyDType dtype() const { return dtype_; }
+    size_t count() const { return count_; }
+
+    // Read elements [first, first + n) into dst (n * npy_dtype_size(dtype()) bytes).
+    bool read(size_t first, size_t n, void *dst, std::string &errorMessage);
+
+private:
+    std::ifstream in_;
+    NpyInfo info_;
+    NpyDType dtype_ = NpyDType::F4;
+    size_t dataOffset_ = 0;
+    size_t count_ = 0;
+    bool swap_ = false;
+};
@@ -0,0 +1,202 @@
+#include "npy_writer.h"
+#include "chunk_encoder.h"
+
+#include <array>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+constexpr size_t kNpyAlign = 64;
+
+// NPY 1.0 头：magic + 版本 + 头长度 + 字典，空格补齐使 10 + 头长度 为 64 的倍数
+std::string npy_header(const std::string &descr, const std::vector<size_t> &shape) {
+    std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+    for (size_t i = 0; i < shape.size(); ++i) {
+        if (i > 0) dict += ", ";
+        dict += std::to_string(shape[i]);
+    }
+    dict += shape.size() == 1 ? ",), }" : "), }";
+    const size_t unpadded = 10 + dict.size() + 1;
+    dict.append((kNpyAlign - unpadded % kNpyAlign) % kNpyAlign, ' ');
+    dict += '\n';
+
+    std::string header("\x93NUMPY\x01\x00", 8);
+    header += static_cast<char>(dict.size() & 0xFF);
+    header += static_cast<char>((dict.size() >> 8) & 0xFF);
+    return header + dict;
+}
+
+std::string float_descr() { return host_is_big_endian() ? ">f4" : "<f4"; }
+std::string uint_descr() { return host_is_big_endian() ? ">u4" : "<u4"; }
+
+// CRC-32（IEEE，slicing-by-8），供 ZIP 成员校验
+class Crc32 {
+public:
+    Crc32() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table_[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t t = 1; t < 8; ++t) table_[t][i] = (table_[t - 1][i] >> 8) ^ table_[0][table_[t - 1][i] & 0xFF];
+        }
+    }
+
+    uint32_t update(uint32_t crc, const void *data, size_t n) const {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        crc = ~crc;
+        for (; n >= 8; n -= 8, p += 8) {
+            const uint32_t lo = crc ^ (uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24);
+            crc = table_[7][lo & 0xFF] ^ table_[6][(lo >> 8) & 0xFF] ^ table_[5][(lo >> 16) & 0xFF] ^ table_[4][lo >> 24]
+                ^ table_[3][p[4]] ^ table_[2][p[5]] ^ table_[1][p[6]] ^ table_[0][p[7]];
+        }
+        for (; n > 0; --n, ++p) crc = (crc >> 8) ^ table_[0][(crc ^ *p) & 0xFF];
+        return ~crc;
+    }
+
+private:
+    std::array<std::array<uint32_t, 256>, 8> table_;
+};
+
+void put_le16(std::string &buf, uint32_t v) {
+    buf += static_cast<char>(v & 0xFF);
+    buf += static_cast<char>((v >> 8) & 0xFF);
+}
+
+void put_le32(std::string &buf, uint32_t v) {
+    put_le16(buf, v & 0xFFFF);
+    put_le16(buf, v >> 16);
+}
+
+struct ZipMember {
+    std::string name;
+    std::string npyHeader;
+    const void *data;
+    size_t bytes;
+    uint32_t crc = 0;
+    uint64_t offset = 0;   // 本地文件头在 ZIP 中的偏移
+};
+
+} // namespace
+
+bool write_npy(const std::string &path, const std::string &descr, const std::vector<size_t> &shape,
+               const void *data, size_t bytes, std::string &errorMessage) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入NPY文件: " + path; return false; }
+    const std::string header = npy_header(descr, shape);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    if (bytes > 0) out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+    if (!out) { errorMessage = "写NPY失败: " + path; return false; }
+    return true;
+}
+
+bool write_mesh_npy(const std::string &vertsPath, const std::string &trisPath,
+                    const std::vector<MCVertex> &vertices,
+                    const std::vector<MCTriangle> &triangles,
+                    std::string &errorMessage) {
+    return write_npy(vertsPath, float_descr(), {vertices.size(), 3}, vertices.data(),
+                     vertices.size() * sizeof(MCVertex), errorMessage) &&
+           write_npy(trisPath, uint_descr(), {triangles.size(), 3}, triangles.data(),
+                     triangles.size() * sizeof(MCTriangle), errorMessage);
+}
+
+bool write_normals_npy(const std::string &path, const std::vector<MCNormal> &normals,
+                       std::string &errorMessage) {
+    return write_npy(path, float_descr(), {normals.size(), 3}, normals.data(),
+                     normals.size() * sizeof(MCNormal), errorMessage);
+}
+
+bool write_mesh_npz(const std::string &path,
+                    const std::vector<MCVertex> &vertices,
+                    const std::vector<MCTriangle> &triangles,
+                    std::string &errorMessage,
+                    const std::vector<MCNormal> *normals) {
+    static const Crc32 crc32;
+    std::vector<ZipMember> members = {
+        {"verts.npy", npy_header(float_descr(), {vertices.size(), 3}), vertices.data(), vertices.size() * sizeof(MCVertex)},
+        {"tris.npy", npy_header(uint_descr(), {triangles.size(), 3}), triangles.data(), triangles.size() * sizeof(MCTriangle)},
+    };
+    if (normals) {
+        members.push_back({"normals.npy", npy_header(float_descr(), {normals->size(), 3}), normals->data(),
+                           normals->size() * sizeof(MCNormal)});
+    }
+
+    // 不使用 ZIP64：成员与整个文件都必须小于 4GB
+    uint64_t total = 0;
+    for (const auto &m : members) total += 30 + m.name.size() + kNpyAlign + 4 + m.npyHeader.size() + m.bytes + 46 + m.name.size();
+    if (total + 22 >= std::numeric_limits<uint32_t>::max()) { errorMessage = "网格超出NPZ 4GB上限，请改用 --format npy"; return false; }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入NPZ文件: " + path; return false; }
+
+    // 本地文件头 + 成员数据（存储方式，不压缩）；extra 字段补齐使数组数据 64 字节对齐
+    uint64_t offset = 0;
+    for (auto &m : members) {
+        m.crc = crc32.update(crc32.update(0, m.npyHeader.data(), m.npyHeader.size()), m.data, m.bytes);
+        m.offset = offset;
+        const uint32_t size = static_cast<uint32_t>(m.npyHeader.size() + m.bytes);
+        size_t pad = (kNpyAlign - (offset + 30 + m.name.size()) % kNpyAlign) % kNpyAlign;
+        if (pad > 0 && pad < 4) pad += kNpyAlign;   // extra 记录至少 4 字节（ID + 长度）
+
+        std::string header;
+        put_le32(header, 0x04034b50);
+        put_le16(header, 20);          // version needed
+        put_le16(header, 0);           // flags
+        put_le16(header, 0);           // stored
+        put_le16(header, 0);           // time
+        put_le16(header, 0x21);        // date 1980-01-01
+        put_le32(header, m.crc);
+        put_le32(header, size);
+        put_le32(header, size);
+        put_le16(header, static_cast<uint32_t>(m.name.size()));
+        put_le16(header, static_cast<uint32_t>(pad));
+        header += m.name;
+        if (pad > 0) {
+            put_le16(header, 0xD935);  // 对齐填充记录
+            put_le16(header, static_cast<uint32_t>(pad - 4));
+            header.append(pad - 4, '\0');
+        }
+        header += m.npyHeader;
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        if (m.bytes > 0) out.write(static_cast<const char *>(m.data), static_cast<std::streamsize>(m.bytes));
+        offset += header.size() + m.bytes;
+    }
+
+    // 中央目录 + 目录结束记录
+    std::string directory;
+    for (const auto &m : members) {
+        const uint32_t size = static_cast<uint32_t>(m.npyHeader.size() + m.bytes);
+        put_le32(directory, 0x02014b50);
+        put_le16(directory, 20);       // version made by
+        put_le16(directory, 20);       // version needed
+        put_le16(directory, 0);
+        put_le16(directory, 0);
+        put_le16(directory, 0);
+        put_le16(directory, 0x21);
+        put_le32(directory, m.crc);
+        put_le32(directory, size);
+        put_le32(directory, size);
+        put_le16(directory, static_cast<uint32_t>(m.name.size()));
+        put_le16(directory, 0);        // extra
+        put_le16(directory, 0);        // comment
+        put_le16(directory, 0);        // disk
+        put_le16(directory, 0);        // internal attributes
+        put_le32(directory, 0);        // external attributes
+        put_le32(directory, static_cast<uint32_t>(m.offset));
+        directory += m.name;
+    }
+    const uint32_t directorySize = static_cast<uint32_t>(directory.size());
+    put_le32(directory, 0x06054b50);
+    put_le16(directory, 0);
+    put_le16(directory, 0);
+    put_le16(directory, static_cast<uint32_t>(members.size()));
+    put_le16(directory, static_cast<uint32_t>(members.size()));
+    put_le32(directory, directorySize);
+    put_le32(directory, static_cast<uint32_t>(offset));
+    put_le16(directory, 0);
+    out.write(directory.data(), static_cast<std::streamsize>(directory.size()));
+    if (!out) { errorMessage = "写NPZ失败: " + path; return false; }
+    return true;
+}
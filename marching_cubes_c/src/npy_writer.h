@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "marching_cubes.h"
+
+// NPY/NPZ output matching npy_reader: arrays are written as a header padded so
+// the data starts on a 64-byte boundary, followed by the contiguous array in a
+// single write(). numpy can open the .npy files with np.load(mmap_mode='r').
+
+// Write one C-order array; descr is a numpy type string such as "<f4".
+bool write_npy(const std::string &path, const std::string &descr, const std::vector<size_t> &shape,
+               const void *data, size_t bytes, std::string &errorMessage);
+
+// Mesh as two arrays: verts (N,3) float32 and tris (M,3) uint32.
+bool write_mesh_npy(const std::string &vertsPath, const std::string &trisPath,
+                    const std::vector<MCVertex> &vertices,
+                    const std::vector<MCTriangle> &triangles,
+                    std::string &errorMessage);
+
+// Vertex normals as an (N,3) float32 array.
+bool write_normals_npy(const std::string &path, const std::vector<MCNormal> &normals,
+                       std::string &errorMessage);
+
+// Both arrays in one uncompressed .npz ("verts", "tris", plus "normals" when
+// given). Members are stored,
+// not deflated, and their data is 64-byte aligned inside the file so it can be
+// memory-mapped at a fixed offset.
+bool write_mesh_npz(const std::string &path,
+                    const std::vector<MCVertex> &vertices,
+                    const std::vector<MCTriangle> &triangles,
+                    std::string &errorMessage,
+                    const std::vector<MCNormal> *normals = nullptr);
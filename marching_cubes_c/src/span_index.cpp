@@ -0,0 +1,207 @@
+#include "span_index.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'C', 'S', 'P', 'A', 'N', '0', '1'};
+constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+struct Interval {
+    float lo, hi;
+    uint32_t brick;
+};
+
+// 源 NPY 的大小与修改时间，用于判断磁盘上的索引是否过期
+bool source_stamp(const std::string &path, uint64_t &size, int64_t &mtime, std::string &err) {
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(path, ec);
+    if (ec) { err = "无法获取文件大小: " + path; return false; }
+    const auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec) { err = "无法获取修改时间: " + path; return false; }
+    size = static_cast<uint64_t>(fileSize);
+    mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+template <typename T>
+void write_pod(std::ofstream &out, const T &v) { out.write(reinterpret_cast<const char *>(&v), sizeof(T)); }
+
+template <typename T>
+bool read_pod(std::ifstream &in, T &v) { return static_cast<bool>(in.read(reinterpret_cast<char *>(&v), sizeof(T))); }
+
+template <typename T>
+void write_array(std::ofstream &out, const std::vector<T> &v) {
+    write_pod(out, static_cast<uint64_t>(v.size()));
+    if (!v.empty()) out.write(reinterpret_cast<const char *>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+template <typename T>
+bool read_array(std::ifstream &in, std::vector<T> &v, uint64_t maxCount) {
+    uint64_t n = 0;
+    if (!read_pod(in, n) || n > maxCount) return false;
+    v.resize(static_cast<size_t>(n));
+    return n == 0 || static_cast<bool>(in.read(reinterpret_cast<char *>(v.data()), static_cast<std::streamsize>(n * sizeof(T))));
+}
+
+} // namespace
+
+std::string span_index_path(const std::string &inputPath) {
+    return inputPath + ".mcidx";
+}
+
+void SpanSpaceIndex::build(const MinMaxBlockIndex &blocks, int nx, int ny, int nz) {
+    nx_ = nx; ny_ = ny; nz_ = nz;
+    bricksX_ = blocks.bricks_x();
+    bricksY_ = blocks.bricks_y();
+    bricksZ_ = blocks.bricks_z();
+    nodes_.clear(); byLo_.clear(); byHi_.clear();
+    root_ = kNone;
+
+    // 值域退化 (min == max) 的 brick 不可能跨越任何等值，直接排除（背景 brick 大多如此）
+    std::vector<Interval> intervals;
+    for (size_t i = 0; i < blocks.brick_count(); ++i) {
+        const float lo = blocks.brick_min(i), hi = blocks.brick_max(i);
+        if (lo < hi) intervals.push_back({lo, hi, static_cast<uint32_t>(i)});
+    }
+    if (intervals.empty()) return;
+    byLo_.reserve(intervals.size());
+    byHi_.reserve(intervals.size());
+
+    // 中心区间树：中心取区间上端的中位数，上端等于中心的区间必然留在结点内，保证递归收敛。
+    // 子树任务记录父结点下标与方向 (0=根, 1=左, 2=右)，结点建好后回填父结点链接
+    struct Pending { size_t begin, end; uint32_t parent; int side; };
+    std::vector<Pending> stack{{0, intervals.size(), kNone, 0}};
+    std::vector<Interval> scratch;
+    while (!stack.empty()) {
+        const Pending job = stack.back();
+        stack.pop_back();
+        const auto first = intervals.begin() + static_cast<std::ptrdiff_t>(job.begin);
+        const auto last = intervals.begin() + static_cast<std::ptrdiff_t>(job.end);
+        const auto mid = first + (last - first) / 2;
+        std::nth_element(first, mid, last, [](const Interval &a, const Interval &b) { return a.hi < b.hi; });
+        const float center = mid->hi;
+
+        // 划分为 [左: hi < c) [结点: lo < c <= hi) [右: lo >= c)
+        const auto leftEnd = std::partition(first, last, [&](const Interval &v) { return v.hi < center; });
+        const auto nodeEnd = std::partition(leftEnd, last, [&](const Interval &v) { return v.lo < center; });
+
+        const uint32_t nodeId = static_cast<uint32_t>(nodes_.size());
+        if (job.side == 0) root_ = nodeId;
+        else if (job.side == 1) nodes_[job.parent].left = nodeId;
+        else nodes_[job.parent].right = nodeId;
+        nodes_.push_back({center, kNone, kNone, static_cast<uint32_t>(byLo_.size()),
+                          static_cast<uint32_t>(nodeEnd - leftEnd)});
+
+        scratch.assign(leftEnd, nodeEnd);
+        std::sort(scratch.begin(), scratch.end(), [](const Interval &a, const Interval &b) { return a.lo < b.lo; });
+        for (const auto &v : scratch) byLo_.push_back({v.lo, v.brick});
+        std::sort(scratch.begin(), scratch.end(), [](const Interval &a, const Interval &b) { return a.hi > b.hi; });
+        for (const auto &v : scratch) byHi_.push_back({v.hi, v.brick});
+
+        const size_t leftSplit = job.begin + static_cast<size_t>(leftEnd - first);
+        const size_t rightSplit = job.begin + static_cast<size_t>(nodeEnd - first);
+        if (job.begin < leftSplit) stack.push_back({job.begin, leftSplit, nodeId, 1});
+        if (rightSplit < job.end) stack.push_back({rightSplit, job.end, nodeId, 2});
+    }
+}
+
+void SpanSpaceIndex::find_active(float iso, ActiveBricks &out) const {
+    out.bricksX = bricksX_;
+    out.bricksY = bricksY_;
+    out.bricksZ = bricksZ_;
+    out.active.assign(brick_count(), 0);
+    out.activeCount = 0;
+
+    // 查询点 q 落在 (lo, hi] 内即活跃，与 brick_straddles 的判定一致
+    const float q = iso - 1e-6f;
+    const auto mark = [&](uint32_t brick) {
+        out.active[brick] = 1;
+        ++out.activeCount;
+    };
+    uint32_t node = root_;
+    while (node != kNone) {
+        const Node &n = nodes_[node];
+        if (q < n.center) {
+            // 结点内区间 hi >= c > q，只需 lo < q；右子树 lo >= c 全部落选
+            for (uint32_t i = n.begin; i < n.begin + n.count && byLo_[i].value < q; ++i) mark(byLo_[i].brick);
+            node = n.left;
+        } else {
+            // 结点内区间 lo < c <= q，只需 hi >= q；左子树 hi < c 全部落选
+            for (uint32_t i = n.begin; i < n.begin + n.count && !(byHi_[i].value < q); ++i) mark(byHi_[i].brick);
+            node = n.right;
+        }
+    }
+}
+
+bool SpanSpaceIndex::save(const std::string &path, const std::string &sourcePath, std::string &err) const {
+    uint64_t srcSize = 0; int64_t srcTime = 0;
+    if (!source_stamp(sourcePath, srcSize, srcTime, err)) return false;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { err = "无法写入索引文件: " + path; return false; }
+    out.write(kMagic, sizeof(kMagic));
+    write_pod(out, static_cast<int32_t>(kBrickSize));
+    write_pod(out, srcSize);
+    write_pod(out, srcTime);
+    for (int v : {nx_, ny_, nz_, bricksX_, bricksY_, bricksZ_}) write_pod(out, static_cast<int32_t>(v));
+    write_pod(out, root_);
+    write_array(out, nodes_);
+    write_array(out, byLo_);
+    write_array(out, byHi_);
+    if (!out) { err = "写入索引文件失败: " + path; return false; }
+    return true;
+}
+
+bool SpanSpaceIndex::load(const std::string &path, const std::string &sourcePath, int nx, int ny, int nz,
+                          std::string &err) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { err = "无法打开索引文件: " + path; return false; }
+    char magic[8];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 8, kMagic)) { err = "不是span索引文件"; return false; }
+
+    int32_t brickSize = 0;
+    uint64_t srcSize = 0; int64_t srcTime = 0;
+    int32_t dims[6] = {0};
+    if (!read_pod(in, brickSize) || !read_pod(in, srcSize) || !read_pod(in, srcTime)) { err = "索引头不完整"; return false; }
+    for (auto &d : dims) if (!read_pod(in, d)) { err = "索引头不完整"; return false; }
+    if (brickSize != kBrickSize) { err = "索引brick尺寸不匹配"; return false; }
+    if (dims[0] != nx || dims[1] != ny || dims[2] != nz ||
+        dims[3] != bricks_along(nx) || dims[4] != bricks_along(ny) || dims[5] != bricks_along(nz)) {
+        err = "索引与体数据尺寸不匹配"; return false;
+    }
+    uint64_t curSize = 0; int64_t curTime = 0;
+    if (!source_stamp(sourcePath, curSize, curTime, err)) return false;
+    if (curSize != srcSize || curTime != srcTime) { err = "索引已过期（源文件已修改）"; return false; }
+
+    const uint64_t bricks = static_cast<uint64_t>(dims[3]) * dims[4] * dims[5];
+    uint32_t root = kNone;
+    std::vector<Node> nodes; std::vector<Entry> byLo, byHi;
+    if (!read_pod(in, root) || !read_array(in, nodes, bricks) || !read_array(in, byLo, bricks) ||
+        !read_array(in, byHi, bricks) || byLo.size() != byHi.size()) {
+        err = "索引内容损坏"; return false;
+    }
+    if (root != kNone && root >= nodes.size()) { err = "索引内容损坏"; return false; }
+    // 结点按先父后子的顺序建立，子结点下标必然大于父结点；自环或回指会使 find_active 死循环
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node &n = nodes[i];
+        if ((n.left != kNone && (n.left <= i || n.left >= nodes.size())) ||
+            (n.right != kNone && (n.right <= i || n.right >= nodes.size())) ||
+            static_cast<uint64_t>(n.begin) + n.count > byLo.size()) {
+            err = "索引内容损坏"; return false;
+        }
+    }
+    for (size_t i = 0; i < byLo.size(); ++i) {
+        if (byLo[i].brick >= bricks || byHi[i].brick >= bricks) { err = "索引内容损坏"; return false; }
+    }
+
+    nx_ = nx; ny_ = ny; nz_ = nz;
+    bricksX_ = dims[3]; bricksY_ = dims[4]; bricksZ_ = dims[5];
+    root_ = root;
+    nodes_ = std::move(nodes);
+    byLo_ = std::move(byLo);
+    byHi_ = std::move(byHi);
+    return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "block_index.h"
+
+// Span-space index over per-brick value ranges for interactive iso sweeps.
+// Each brick with a non-degenerate range contributes the interval (min, max];
+// a brick is active for iso when min < iso - 1e-6f <= max (same rule as
+// brick_straddles). The intervals are kept in a flattened centered interval
+// tree, so active bricks for a new iso value are found in O(log n + k) without
+// touching the volume. The index can be saved next to the NPY file and reused
+// across runs; it records the source file size and mtime to detect staleness.
+
+class SpanSpaceIndex {
+public:
+    SpanSpaceIndex() = default;
+
+    void build(const MinMaxBlockIndex &blocks, int nx, int ny, int nz);
+
+    // Mark bricks whose range contains the iso value.
+    void find_active(float isoValue, ActiveBricks &out) const;
+
+    bool save(const std::string &path, const std::string &sourcePath, std::string &errorMessage) const;
+    // Fails when the file is missing, corrupt, or does not match the source volume.
+    bool load(const std::string &path, const std::string &sourcePath, int nx, int ny, int nz,
+              std::string &errorMessage);
+
+    size_t interval_count() const { return byLo_.size(); }
+    size_t brick_count() const { return static_cast<size_t>(bricksX_) * bricksY_ * bricksZ_; }
+
+private:
+    struct Node {
+        float center;
+        uint32_t left, right;   // child node index, kNone when absent
+        uint32_t begin, count;  // range in byLo_ / byHi_
+    };
+    struct Entry {
+        float value;            // interval min in byLo_, max in byHi_
+        uint32_t brick;
+    };
+
+    int nx_ = 0, ny_ = 0, nz_ = 0;
+    int bricksX_ = 0, bricksY_ = 0, bricksZ_ = 0;
+    uint32_t root_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<Entry> byLo_;   // per node, ascending by min
+    std::vector<Entry> byHi_;   // per node, descending by max
+};
+
+// Default index location for an input volume: "<input>.mcidx".
+std::string span_index_path(const std::string &inputPath);
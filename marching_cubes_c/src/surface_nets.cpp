@@ -0,0 +1,329 @@
+#include "mc_common.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Surface Nets（Gibson 1998，朴素版本）：每个活跃单元放一个顶点，取单元内各边交点的平均位置
+// （只有体边界上切割边的边界单元不被任何四边形引用，不输出顶点）；
+// 每条被切割的内部边把周围 4 个单元的顶点连成一个四边形，沿较短的对角线剖分为两个三角形（或按 MCOptions::quads 原样输出）。
+// 与 marching_cubes.cpp 一样按 z-slab 两遍提取：第一遍统计各单元层的顶点数与四边形数，
+// 前缀和后第二遍按层偏移直接写入。单元顶点编号与位置保存在滑动的两层切片中（本层与上一层），
+// slab 首层用到的上一层由本 slab 重新分类得到，因此不需要跨 slab 回填。
+
+namespace {
+
+// 单元 (x,y,z) 负责的四边形：从其最小角点出发的 x/y/z 边（位 0/1/2）被切割，且周围 4 个单元
+// 都在体内。立方体索引位 i 表示角点 i 低于等值，角点 1/3/4 沿 x/y/z 与角点 0 相邻
+inline int quad_edges(int cube, int x, int y, int z) {
+    int m = 0;
+    if (y > 0 && z > 0 && ((cube ^ (cube >> 1)) & 1)) m |= 1;
+    if (x > 0 && z > 0 && ((cube ^ (cube >> 3)) & 1)) m |= 2;
+    if (x > 0 && y > 0 && ((cube ^ (cube >> 4)) & 1)) m |= 4;
+    return m;
+}
+
+// 立方体角点相对最小角点的偏移（与 cell_vertex 的角点顺序一致）
+inline constexpr int kCornerOffset[8][3] = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1},
+};
+
+// 单元 (x,y,z) 的顶点是否被四边形引用：存在一条被切割、且周围 4 个单元都在体内的边。
+// 不贴体边界的单元的边都满足；边界单元只有体边界上的切割边时不输出顶点
+inline bool cell_referenced(int cube, int x, int y, int z, int nx, int ny, int nz) {
+    if (x > 0 && x < nx - 2 && y > 0 && y < ny - 2 && z > 0 && z < nz - 2) return true;
+    const int pos[3] = {x, y, z}, dim[3] = {nx, ny, nz};
+    const int edges = edgeTable[cube];
+    for (int e = 0; e < 12; ++e) {
+        if (!(edges & (1 << e))) continue;
+        const int *a = kCornerOffset[kEdgeCorners[e][0]], *b = kCornerOffset[kEdgeCorners[e][1]];
+        bool interior = true;
+        for (int k = 0; k < 3; ++k) {
+            const int c = pos[k] + a[k];
+            if (a[k] == b[k] && (c < 1 || c > dim[k] - 2)) interior = false;
+        }
+        if (interior) return true;
+    }
+    return false;
+}
+
+// 逐层分类：平面 z / z+1 的 below 掩码整面生成，相邻层复用共享平面
+template <typename Voxel>
+class CellLayers {
+public:
+    CellLayers(const Voxel *vol, int nx, int ny, float isoBias)
+        : vol_(vol), nx_(static_cast<size_t>(nx)), ny_(static_cast<size_t>(ny)),
+          kernels_(cube_classify_kernels()), threshold_(isoBias),
+          lo_(nx_ * ny_), hi_(nx_ * ny_), cubes_(nx_ - 1), active_((nx_ - 1 + 63) / 64) {}
+
+    void begin_layer(int z) {
+        if (z == z_ + 1) std::swap(lo_, hi_);
+        else classify_plane(z, lo_);
+        classify_plane(z + 1, hi_);
+        z_ = z;
+    }
+
+    // 单元行 y 的立方体索引与活跃位图，返回活跃单元数
+    size_t classify_row(int y) {
+        const size_t r = static_cast<size_t>(y) * nx_;
+        return kernels_.buildCubeRow(lo_.data() + r, lo_.data() + r + nx_, hi_.data() + r, hi_.data() + r + nx_,
+                                     nx_ - 1, cubes_.data(), active_.data());
+    }
+
+    int cube(int x) const { return cubes_[static_cast<size_t>(x)]; }
+
+    template <typename Fn>
+    void for_each_active(Fn &&fn) const {
+        for_each_active_cell(active_.data(), active_.size(), fn);
+    }
+
+private:
+    void classify_plane(int z, std::vector<uint8_t> &mask) const {
+        threshold_.classify(kernels_, vol_ + static_cast<size_t>(z) * nx_ * ny_, nx_ * ny_, mask.data());
+    }
+
+    const Voxel *vol_;
+    size_t nx_, ny_;
+    const CubeClassifyKernels &kernels_;
+    VoxelThreshold<Voxel> threshold_;
+    int z_ = -2;
+    std::vector<uint8_t> lo_, hi_;
+    std::vector<uint8_t> cubes_;
+    std::vector<uint64_t> active_;
+};
+
+template <typename Vec3>
+inline float dist2(const Vec3 &a, const Vec3 &b) {
+    const float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// 四边形 q（绕序 0→1→2→3）沿较短的对角线剖分为两个三角形
+template <typename Vec3>
+inline void split_quad(const uint32_t q[4], const Vec3 v[4], MCTriangle *out) {
+    if (dist2(v[0], v[2]) <= dist2(v[1], v[3])) {
+        out[0] = {q[0], q[1], q[2]};
+        out[1] = {q[0], q[2], q[3]};
+    } else {
+        out[0] = {q[0], q[1], q[3]};
+        out[1] = {q[1], q[2], q[3]};
+    }
+}
+
+template <typename Voxel>
+class SurfaceNets {
+public:
+    SurfaceNets(const Voxel *vol, int nx, int ny, int nz, float iso)
+        : vol_(vol), nx_(nx), ny_(ny), nz_(nz), iso_(iso) {}
+
+    // Q 非空时输出四边形，T 保持为空
+    void run(int numThreads, std::vector<MCVertex> &V, std::vector<MCTriangle> &T, std::vector<MCQuad> *Q,
+             std::vector<MCNormal> *normals) {
+        const int layers = nz_ - 1;
+        const int numSlabs = std::max(1, std::min(numThreads, layers));
+        const auto slab_begin = [&](int s) { return static_cast<int>(static_cast<int64_t>(layers) * s / numSlabs); };
+
+        // 第一遍：各单元层的顶点数与四边形数
+        vertexOffset_.assign(static_cast<size_t>(layers) + 1, 0);
+        triangleOffset_.assign(static_cast<size_t>(layers) + 1, 0);
+        parallel_for(numSlabs, numSlabs, [&](int s) { count_layers(slab_begin(s), slab_begin(s + 1)); });
+
+        // 前缀和：第 z 层的顶点与面（四边形，或每个四边形两个三角形）写入偏移
+        const size_t facesPerQuad = Q ? 1 : 2;
+        size_t vertices = 0, triangles = 0;
+        for (size_t z = 0; z <= static_cast<size_t>(layers); ++z) {
+            const size_t nv = vertexOffset_[z], nt = triangleOffset_[z] * facesPerQuad;
+            vertexOffset_[z] = vertices;
+            triangleOffset_[z] = triangles;
+            vertices += nv;
+            triangles += nt;
+        }
+        V.resize(vertices);
+        if (Q) Q->resize(triangles);
+        else T.resize(triangles);
+        if (normals) normals->resize(vertices);
+
+        // 第二遍：各 slab 写入各自的层区间，结果与线程数无关
+        MCVertex *outV = V.data();
+        MCTriangle *outT = Q ? nullptr : T.data();
+        MCQuad *outQ = Q ? Q->data() : nullptr;
+        MCNormal *outN = normals ? normals->data() : nullptr;
+        parallel_for(numSlabs, numSlabs, [&](int s) {
+            fill_layers(slab_begin(s), slab_begin(s + 1), outV, outT, outQ, outN);
+        });
+    }
+
+private:
+    // 暂存各层的顶点数与四边形数，前缀和后改为偏移
+    void count_layers(int z0, int z1) {
+        CellLayers<Voxel> cells(vol_, nx_, ny_, iso_ - 1e-6f);
+        for (int z = z0; z < z1; ++z) {
+            size_t vertices = 0, quads = 0;
+            cells.begin_layer(z);
+            for (int y = 0; y < ny_ - 1; ++y) {
+                if (cells.classify_row(y) == 0) continue;
+                cells.for_each_active([&](int x) {
+                    if (!cell_referenced(cells.cube(x), x, y, z, nx_, ny_, nz_)) return;
+                    ++vertices;
+                    quads += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(quad_edges(cells.cube(x), x, y, z))));
+                });
+            }
+            vertexOffset_[static_cast<size_t>(z)] = vertices;
+            triangleOffset_[static_cast<size_t>(z)] = quads;
+        }
+    }
+
+    // 单元顶点：各切割边交点的平均位置；法向为各交点处插值梯度之和（与 edge_normal 同一定义）
+    EdgeVertex cell_vertex(int x, int y, int z, int cube, MCNormal *normal) const {
+        const size_t sy = static_cast<size_t>(nx_), sz = sy * static_cast<size_t>(ny_);
+        const Voxel *c = vol_ + static_cast<size_t>(z) * sz + static_cast<size_t>(y) * sy + static_cast<size_t>(x);
+        const float val[8] = {
+            static_cast<float>(c[0]),           static_cast<float>(c[1]),
+            static_cast<float>(c[sy + 1]),      static_cast<float>(c[sy]),
+            static_cast<float>(c[sz]),          static_cast<float>(c[sz + 1]),
+            static_cast<float>(c[sz + sy + 1]), static_cast<float>(c[sz + sy]),
+        };
+        const float fx = static_cast<float>(x), fy = static_cast<float>(y), fz = static_cast<float>(z);
+        const EdgeVertex p[8] = {
+            {fx, fy, fz}, {fx + 1, fy, fz}, {fx + 1, fy + 1, fz}, {fx, fy + 1, fz},
+            {fx, fy, fz + 1}, {fx + 1, fy, fz + 1}, {fx + 1, fy + 1, fz + 1}, {fx, fy + 1, fz + 1},
+        };
+        float g[8][3];
+        if (normal) {
+            for (int k = 0; k < 8; ++k) {
+                voxel_gradient(vol_, nx_, ny_, nz_, static_cast<int>(p[k].x), static_cast<int>(p[k].y),
+                               static_cast<int>(p[k].z), g[k]);
+            }
+        }
+
+        const int edges = edgeTable[cube];
+        EdgeVertex sum = {0.0f, 0.0f, 0.0f};
+        float n[3] = {0.0f, 0.0f, 0.0f};
+        int count = 0;
+        for (int e = 0; e < 12; ++e) {
+            if (!(edges & (1 << e))) continue;
+            const int a = kEdgeCorners[e][0], b = kEdgeCorners[e][1];
+            const EdgeVertex v = vertex_lerp(iso_, p[a], p[b], val[a], val[b]);
+            sum.x += v.x; sum.y += v.y; sum.z += v.z;
+            ++count;
+            if (normal) {
+                const float t = edge_weight(iso_, val[a], val[b]);
+                for (int k = 0; k < 3; ++k) n[k] += g[a][k] + t * (g[b][k] - g[a][k]);
+            }
+        }
+        if (normal) {
+            const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            *normal = len > 0.0f ? MCNormal{n[0] / len, n[1] / len, n[2] / len} : MCNormal{0.0f, 0.0f, 0.0f};
+        }
+        const float inv = 1.0f / static_cast<float>(count);
+        return {sum.x * inv, sum.y * inv, sum.z * inv};
+    }
+
+    // 单元层 [z0, z1)。z0>0 时先重建 z0-1 层的编号与位置（不写出），供首层四边形引用
+    void fill_layers(int z0, int z1, MCVertex *outV, MCTriangle *outT, MCQuad *outQ, MCNormal *outN) const {
+        const size_t cellsX = static_cast<size_t>(nx_ - 1);
+        const size_t slice = cellsX * static_cast<size_t>(ny_ - 1);
+        std::vector<uint32_t> prevId(slice), curId(slice);
+        std::vector<EdgeVertex> prevPos(slice), curPos(slice);
+        CellLayers<Voxel> cells(vol_, nx_, ny_, iso_ - 1e-6f);
+
+        for (int z = std::max(0, z0 - 1); z < z1; ++z) {
+            const bool emit = z >= z0;
+            uint32_t nextVertex = static_cast<uint32_t>(vertexOffset_[static_cast<size_t>(z)]);
+            size_t nextFace = triangleOffset_[static_cast<size_t>(z)];
+
+            // 四边形 a→b→c→d 的绕序按第一轴、第二轴递增，法向沿边的正方向；
+            // 边的起点在面外（不低于等值）时梯度反向，绕序随之反转。outQ 非空时原样写出，否则剖分
+            const auto emit_quad = [&](size_t a, size_t b, size_t c, size_t d,
+                                       const std::vector<uint32_t> &ida, const std::vector<EdgeVertex> &pa,
+                                       const std::vector<uint32_t> &idb, const std::vector<EdgeVertex> &pb,
+                                       const std::vector<uint32_t> &idc, const std::vector<EdgeVertex> &pc,
+                                       const std::vector<uint32_t> &idd, const std::vector<EdgeVertex> &pd,
+                                       bool startBelow) {
+                uint32_t q[4] = {ida[a], idb[b], idc[c], idd[d]};
+                EdgeVertex v[4] = {pa[a], pb[b], pc[c], pd[d]};
+                if (!startBelow) {
+                    std::swap(q[1], q[3]);
+                    std::swap(v[1], v[3]);
+                }
+                if (outQ) {
+                    outQ[nextFace++] = {q[0], q[1], q[2], q[3]};
+                } else {
+                    split_quad(q, v, outT + nextFace);
+                    nextFace += 2;
+                }
+            };
+
+            cells.begin_layer(z);
+            for (int y = 0; y < ny_ - 1; ++y) {
+                if (cells.classify_row(y) == 0) continue;
+                cells.for_each_active([&](int x) {
+                    const int cube = cells.cube(x);
+                    if (!cell_referenced(cube, x, y, z, nx_, ny_, nz_)) return;
+                    const size_t i = static_cast<size_t>(y) * cellsX + static_cast<size_t>(x);
+                    MCNormal normal;
+                    const EdgeVertex v = cell_vertex(x, y, z, cube, emit && outN ? &normal : nullptr);
+                    curId[i] = nextVertex;
+                    curPos[i] = v;
+                    if (!emit) { ++nextVertex; return; }
+                    outV[nextVertex] = {v.x, v.y, v.z};
+                    if (outN) outN[nextVertex] = normal;
+                    ++nextVertex;
+
+                    const int quads = quad_edges(cube, x, y, z);
+                    const bool below = cube & 1;
+                    if (quads & 1) {    // x 边：周围单元在 (y, z) 平面，先 y 后 z
+                        emit_quad(i - cellsX, i, i, i - cellsX,
+                                  prevId, prevPos, prevId, prevPos, curId, curPos, curId, curPos, below);
+                    }
+                    if (quads & 2) {    // y 边：(z, x) 平面，先 z 后 x
+                        emit_quad(i - 1, i - 1, i, i,
+                                  prevId, prevPos, curId, curPos, curId, curPos, prevId, prevPos, below);
+                    }
+                    if (quads & 4) {    // z 边：(x, y) 平面，先 x 后 y
+                        emit_quad(i - cellsX - 1, i - cellsX, i, i - 1,
+                                  curId, curPos, curId, curPos, curId, curPos, curId, curPos, below);
+                    }
+                });
+            }
+            std::swap(prevId, curId);
+            std::swap(prevPos, curPos);
+        }
+    }
+
+    const Voxel *vol_;
+    int nx_, ny_, nz_;
+    float iso_;
+    std::vector<size_t> vertexOffset_, triangleOffset_;   // 按单元层
+};
+
+} // namespace
+
+template <typename Voxel>
+void surface_nets(const Voxel *vol, int nx, int ny, int nz, float iso,
+                  std::vector<MCVertex> &V, std::vector<MCTriangle> &T, const MCOptions &options) {
+    V.clear(); T.clear();
+    if (options.quads) options.quads->clear();
+    if (options.normals) options.normals->clear();
+    if (nx < 2 || ny < 2 || nz < 2) return;
+    SurfaceNets<Voxel> engine(vol, nx, ny, nz, iso);
+    engine.run(options.numThreads, V, T, options.quads, options.normals);
+}
+
+void triangulate_quads(const std::vector<MCVertex> &V, const std::vector<MCQuad> &Q, std::vector<MCTriangle> &T) {
+    T.resize(Q.size() * 2);
+    for (size_t k = 0; k < Q.size(); ++k) {
+        const uint32_t q[4] = {Q[k].a, Q[k].b, Q[k].c, Q[k].d};
+        const MCVertex v[4] = {V[q[0]], V[q[1]], V[q[2]], V[q[3]]};
+        split_quad(q, v, T.data() + 2 * k);
+    }
+}
+
+template void surface_nets<float>(const float *, int, int, int, float,
+                                  std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void surface_nets<uint8_t>(const uint8_t *, int, int, int, float,
+                                    std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void surface_nets<int16_t>(const int16_t *, int, int, int, float,
+                                    std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
+template void surface_nets<uint16_t>(const uint16_t *, int, int, int, float,
+                                     std::vector<MCVertex> &, std::vector<MCTriangle> &, const MCOptions &);
@@ -0,0 +1,163 @@
+#include "volume_pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+// NaN 在分类时总被视为“不低于等值”，按 +inf 参与最值统计（与 block_index 一致）
+template <typename T>
+inline T range_value(T v) {
+    return v;
+}
+
+template <>
+inline float range_value<float>(float v) {
+    return v == v ? v : std::numeric_limits<float>::infinity();
+}
+
+// 行内是否有 NaN；没有时直接用原值求最值，免去逐元素替换
+template <typename T>
+inline bool has_nan(const T *, int) {
+    return false;
+}
+
+template <>
+inline bool has_nan<float>(const float *row, int n) {
+    int nan = 0;
+    for (int x = 0; x < n; ++x) nan |= row[x] != row[x];
+    return nan != 0;
+}
+
+// 由上一层（或原始体数据，此时 srcMin == srcMax）的最值生成下一层
+template <typename T>
+void downsample(const T *srcMin, const T *srcMax, int nx, int ny, int nz, int numThreads, PyramidLevel<T> &dst) {
+    const int cx = (nx + 1) / 2, cy = (ny + 1) / 2, cz = (nz + 1) / 2;
+    dst.nx = cx; dst.ny = cy; dst.nz = cz;
+    dst.minVal.resize(static_cast<size_t>(cx) * cy * cz);
+    dst.maxVal.resize(dst.minVal.size());
+    const size_t sy = static_cast<size_t>(nx);
+    const size_t sz = sy * static_cast<size_t>(ny);
+
+    // 先沿 y/z 把 4 个细行逐元素归并（连续访问，可向量化），再在 x 方向两两归并
+    const auto build_plane = [&](int z, std::vector<T> &colMin, std::vector<T> &colMax) {
+        const int z1 = std::min(2 * z + 1, nz - 1);
+        for (int y = 0; y < cy; ++y) {
+            const int y1 = std::min(2 * y + 1, ny - 1);
+            const size_t rows[4] = {
+                static_cast<size_t>(2 * z) * sz + static_cast<size_t>(2 * y) * sy,
+                static_cast<size_t>(2 * z) * sz + static_cast<size_t>(y1) * sy,
+                static_cast<size_t>(z1) * sz + static_cast<size_t>(2 * y) * sy,
+                static_cast<size_t>(z1) * sz + static_cast<size_t>(y1) * sy,
+            };
+            const T *min0 = srcMin + rows[0], *min1 = srcMin + rows[1], *min2 = srcMin + rows[2], *min3 = srcMin + rows[3];
+            const T *max0 = srcMax + rows[0], *max1 = srcMax + rows[1], *max2 = srcMax + rows[2], *max3 = srcMax + rows[3];
+            T *cmn = colMin.data(), *cmx = colMax.data();
+            const int width = nx;   // 局部副本：uint8 写入可能与捕获的 nx 别名，妨碍向量化
+            const auto reduce_columns = [&](auto value) {
+                for (int x = 0; x < width; ++x) {
+                    cmn[x] = std::min(std::min(value(min0[x]), value(min1[x])), std::min(value(min2[x]), value(min3[x])));
+                }
+                for (int x = 0; x < width; ++x) {
+                    cmx[x] = std::max(std::max(value(max0[x]), value(max1[x])), std::max(value(max2[x]), value(max3[x])));
+                }
+            };
+            // 只有原始体数据可能含 NaN（已生成的层中都已替换为 +inf）
+            if (srcMin == srcMax && (has_nan(min0, width) || has_nan(min1, width) ||
+                                     has_nan(min2, width) || has_nan(min3, width))) {
+                reduce_columns([](T v) { return range_value(v); });
+            } else {
+                reduce_columns([](T v) { return v; });
+            }
+            T *outMin = dst.minVal.data() + (static_cast<size_t>(z) * cy + y) * cx;
+            T *outMax = dst.maxVal.data() + (static_cast<size_t>(z) * cy + y) * cx;
+            for (int x = 0; x < width / 2; ++x) outMin[x] = std::min(cmn[2 * x], cmn[2 * x + 1]);
+            for (int x = 0; x < width / 2; ++x) outMax[x] = std::max(cmx[2 * x], cmx[2 * x + 1]);
+            if (width % 2) {
+                outMin[cx - 1] = cmn[width - 1];
+                outMax[cx - 1] = cmx[width - 1];
+            }
+        }
+    };
+
+    const int workers = std::max(1, std::min(numThreads, cz));
+    const auto build_planes = [&](int first) {
+        std::vector<T> colMin(static_cast<size_t>(nx)), colMax(static_cast<size_t>(nx));
+        for (int z = first; z < cz; z += workers) build_plane(z, colMin, colMax);
+    };
+    if (workers == 1) {
+        build_planes(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < workers; ++t) pool.emplace_back(build_planes, t);
+        for (auto &th : pool) th.join();
+    }
+}
+
+} // namespace
+
+template <typename T>
+void build_volume_pyramid(const T *vol, int nx, int ny, int nz, int levels, int numThreads,
+                          std::vector<PyramidLevel<T>> &out) {
+    out.clear();
+    if (levels < 1 || !can_downsample(nx, ny, nz)) return;
+    out.emplace_back();
+    downsample(vol, vol, nx, ny, nz, numThreads, out.back());
+    out.back().scale = 2;
+    extend_volume_pyramid(levels - 1, numThreads, out);
+}
+
+template <typename T>
+void extend_volume_pyramid(int levels, int numThreads, std::vector<PyramidLevel<T>> &out) {
+    for (int k = 0; k < levels; ++k) {
+        const PyramidLevel<T> &src = out.back();
+        if (!can_downsample(src.nx, src.ny, src.nz)) break;
+        PyramidLevel<T> level;
+        downsample(src.minVal.data(), src.maxVal.data(), src.nx, src.ny, src.nz, numThreads, level);
+        level.scale = src.scale * 2;
+        out.push_back(std::move(level));
+    }
+}
+
+template <typename T>
+void pyramid_level_field(const PyramidLevel<T> &level, float iso, std::vector<T> &out) {
+    const float isoBias = iso - 1e-6f;
+    // 不低于分类阈值的最小体素值；整数体素取阈值向上取整，并钳位到类型值域（超出值域时转换未定义，
+    // 且此时所有块都在同一侧，surfaceValue 不会被选中）
+    T surfaceValue;
+    if constexpr (std::is_floating_point_v<T>) {
+        surfaceValue = static_cast<T>(iso);
+    } else {
+        const double lo = static_cast<double>(std::numeric_limits<T>::lowest());
+        const double hi = static_cast<double>(std::numeric_limits<T>::max());
+        const double surface = std::ceil(static_cast<double>(isoBias));
+        surfaceValue = static_cast<T>(!(surface > lo) ? lo : std::min(surface, hi));   // 含 NaN
+    }
+    out.resize(level.minVal.size());
+    const T *minVal = level.minVal.data(), *maxVal = level.maxVal.data();
+    T *dst = out.data();
+    // 无分支选择，便于向量化
+    for (size_t i = 0; i < out.size(); ++i) {
+        const T mn = minVal[i], mx = maxVal[i];
+        const bool inside = !(static_cast<float>(mn) < isoBias);        // 整块在面内
+        const bool outside = static_cast<float>(mx) < isoBias;          // 整块在面外
+        // 跨越等值面：面穿过块中心
+        dst[i] = inside ? mn : outside ? mx : std::min(surfaceValue, mx);
+    }
+}
+
+template void build_volume_pyramid<float>(const float *, int, int, int, int, int, std::vector<PyramidLevel<float>> &);
+template void build_volume_pyramid<uint8_t>(const uint8_t *, int, int, int, int, int, std::vector<PyramidLevel<uint8_t>> &);
+template void build_volume_pyramid<int16_t>(const int16_t *, int, int, int, int, int, std::vector<PyramidLevel<int16_t>> &);
+template void build_volume_pyramid<uint16_t>(const uint16_t *, int, int, int, int, int, std::vector<PyramidLevel<uint16_t>> &);
+template void extend_volume_pyramid<float>(int, int, std::vector<PyramidLevel<float>> &);
+template void extend_volume_pyramid<uint8_t>(int, int, std::vector<PyramidLevel<uint8_t>> &);
+template void extend_volume_pyramid<int16_t>(int, int, std::vector<PyramidLevel<int16_t>> &);
+template void extend_volume_pyramid<uint16_t>(int, int, std::vector<PyramidLevel<uint16_t>> &);
+template void pyramid_level_field<float>(const PyramidLevel<float> &, float, std::vector<float> &);
+template void pyramid_level_field<uint8_t>(const PyramidLevel<uint8_t> &, float, std::vector<uint8_t> &);
+template void pyramid_level_field<int16_t>(const PyramidLevel<int16_t> &, float, std::vector<int16_t> &);
+template void pyramid_level_field<uint16_t>(const PyramidLevel<uint16_t> &, float, std::vector<uint16_t> &);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Min/max volume pyramid for level-of-detail extraction.
+// Level k (k >= 1) halves every axis of level k-1: coarse voxel i covers fine
+// voxels 2i and 2i+1 (the last one alone when the fine size is odd) and stores
+// the minimum and maximum over that block, so thin structures that cross the
+// iso value survive downsampling instead of being averaged away. Each level is
+// built from the previous one, which reads the full volume only once; when a
+// MinMaxBlockIndex is built anyway, it produces the 2x level in the same sweep.
+template <typename T>
+struct PyramidLevel {
+    int nx = 0, ny = 0, nz = 0;
+    int scale = 1;              // fine voxels per coarse voxel along each axis
+    std::vector<T> minVal, maxVal;
+};
+
+// Whether a level of this size can be halved (every axis keeps at least 2 voxels).
+inline bool can_downsample(int nx, int ny, int nz) {
+    return (nx + 1) / 2 >= 2 && (ny + 1) / 2 >= 2 && (nz + 1) / 2 >= 2;
+}
+
+// Build up to `levels` coarse levels below the full-resolution volume; stops
+// early once an axis would drop below 2 voxels. out[0] is the 2x level.
+// Instantiated for the same voxel types as marching_cubes().
+template <typename T>
+void build_volume_pyramid(const T *volume, int nx, int ny, int nz, int levels, int numThreads,
+                          std::vector<PyramidLevel<T>> &out);
+
+// Append up to `levels` further levels, each halving out.back(). Used when the
+// 2x level came from another sweep over the volume (MinMaxBlockIndex::build).
+template <typename T>
+void extend_volume_pyramid(int levels, int numThreads, std::vector<PyramidLevel<T>> &out);
+
+// Scalar field of one level for a given iso value. Blocks entirely on one side
+// of the classification threshold take their value closest to it (max below,
+// min above); blocks that straddle it take the threshold itself, so the
+// surface passes through their centre and thin structures are never lost.
+template <typename T>
+void pyramid_level_field(const PyramidLevel<T> &level, float isoValue, std::vector<T> &out);
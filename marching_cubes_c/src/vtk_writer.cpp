@@ -1,28 +1,351 @@
 #include "vtk_writer.h"
 #include "marching_cubes.h"
+#include "chunk_encoder.h"
 
+#include <charconv>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 
-bool write_vtk_legacy_polydata(const std::string &path,
-                               const std::vector<MCVertex> &vertices,
-                               const std::vector<MCTriangle> &triangles,
-                               std::string &errorMessage) {
-    std::ofstream out(path);
-    if (!out) { errorMessage = "无法写入VTK文件: " + path; return false; }
+namespace {
+
+// ASCII 编码与 iostream 默认格式一致（%g，6 位有效数字），输出逐字节不变
+constexpr size_t kMaxFloatChars = 16;
+constexpr size_t kMaxIndexChars = 20;
+
+inline char *put_float(char *p, float v) {
+    return std::to_chars(p, p + kMaxFloatChars, v, std::chars_format::general, 6).ptr;
+}
+
+template <typename Index>
+inline char *put_index(char *p, Index v) {
+    return std::to_chars(p, p + kMaxIndexChars, v).ptr;
+}
+
+template <typename Vec3>
+void encode_points_ascii(const Vec3 *v, size_t n, std::string &buf) {
+    buf.resize(n * (3 * kMaxFloatChars + 3));
+    char *p = buf.data();
+    for (size_t i = 0; i < n; ++i) {
+        p = put_float(p, v[i].x); *p++ = ' ';
+        p = put_float(p, v[i].y); *p++ = ' ';
+        p = put_float(p, v[i].z); *p++ = '\n';
+    }
+    buf.resize(static_cast<size_t>(p - buf.data()));
+}
+
+// 三角形或四边形单元："<角点数> i0 i1 ..."
+template <typename Face>
+void encode_faces_ascii(const Face *t, size_t n, std::string &buf) {
+    constexpr size_t K = kFaceCorners<Face>;
+    buf.resize(n * (K * kMaxIndexChars + 2 * K));
+    char *p = buf.data();
+    for (size_t i = 0; i < n; ++i) {
+        *p++ = static_cast<char>('0' + K);
+        for (auto c : face_corners(t[i])) { *p++ = ' '; p = put_index(p, c); }
+        *p++ = '\n';
+    }
+    buf.resize(static_cast<size_t>(p - buf.data()));
+}
+
+// legacy 二进制的 3 分量 float 数组（大端）
+template <typename Vec3>
+void write_points_be32(std::ostream &out, const Vec3 *v, size_t n, int numThreads) {
+    write_chunked(out, n, numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        buf.resize((end - begin) * 12);
+        char *p = buf.data();
+        for (size_t i = begin; i < end; ++i) {
+            p = put_be32(p, v[i].x);
+            p = put_be32(p, v[i].y);
+            p = put_be32(p, v[i].z);
+        }
+    });
+}
+
+void write_legacy_header(std::ostream &out, const char *encoding) {
     out << "# vtk DataFile Version 3.0\n";
     out << "marching cubes output\n";
-    out << "ASCII\n";
+    out << encoding << "\n";
     out << "DATASET POLYDATA\n";
+}
+
+template <typename Face>
+bool write_legacy_ascii(const std::string &path,
+                        const std::vector<MCVertex> &vertices,
+                        const std::vector<Face> &triangles,
+                        std::string &errorMessage,
+                        int numThreads,
+                        const std::vector<MCNormal> *normals) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入VTK文件: " + path; return false; }
+    write_legacy_header(out, "ASCII");
     out << "POINTS " << vertices.size() << " float\n";
-    for (const auto &v : vertices) {
-        out << v.x << " " << v.y << " " << v.z << "\n";
-    }
+    write_chunked(out, vertices.size(), numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        encode_points_ascii(vertices.data() + begin, end - begin, buf);
+    });
     size_t nTri = triangles.size();
-    out << "POLYGONS " << nTri << " " << nTri * 4 << "\n";
-    for (const auto &t : triangles) {
-        out << 3 << " " << t.a << " " << t.b << " " << t.c << "\n";
+    out << "POLYGONS " << nTri << " " << nTri * (kFaceCorners<Face> + 1) << "\n";
+    write_chunked(out, nTri, numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        encode_faces_ascii(triangles.data() + begin, end - begin, buf);
+    });
+    if (normals) {
+        out << "POINT_DATA " << normals->size() << "\n";
+        out << "NORMALS Normals float\n";
+        write_chunked(out, normals->size(), numThreads, [&](size_t begin, size_t end, std::string &buf) {
+            encode_points_ascii(normals->data() + begin, end - begin, buf);
+        });
     }
+    if (!out) { errorMessage = "写VTK失败: " + path; return false; }
     return true;
 }
 
+template <typename Face>
+bool write_legacy_binary(const std::string &path,
+                         const std::vector<MCVertex> &vertices,
+                         const std::vector<Face> &triangles,
+                         std::string &errorMessage,
+                         int numThreads,
+                         const std::vector<MCNormal> *normals) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入VTK文件: " + path; return false; }
+    // legacy 二进制格式固定为大端
+    write_legacy_header(out, "BINARY");
+    out << "POINTS " << vertices.size() << " float\n";
+    write_points_be32(out, vertices.data(), vertices.size(), numThreads);
+    const size_t nTri = triangles.size();
+    constexpr size_t K = kFaceCorners<Face>;
+    out << "\nPOLYGONS " << nTri << " " << nTri * (K + 1) << "\n";
+    write_chunked(out, nTri, numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        buf.resize((end - begin) * 4 * (K + 1));
+        char *p = buf.data();
+        for (size_t i = begin; i < end; ++i) {
+            p = put_be32(p, static_cast<uint32_t>(K));
+            for (uint32_t c : face_corners(triangles[i])) p = put_be32(p, c);
+        }
+    });
+    out << "\n";
+    if (normals) {
+        out << "POINT_DATA " << normals->size() << "\n";
+        out << "NORMALS Normals float\n";
+        write_points_be32(out, normals->data(), normals->size(), numThreads);
+        out << "\n";
+    }
+    if (!out) { errorMessage = "写VTK失败: " + path; return false; }
+    return true;
+}
+
+template <typename Face>
+bool write_vtp(const std::string &path,
+               const std::vector<MCVertex> &vertices,
+               const std::vector<Face> &triangles,
+               std::string &errorMessage,
+               int numThreads,
+               const std::vector<MCNormal> *normals) {
+    constexpr size_t K = kFaceCorners<Face>;
+    std::ofstream out(path, std::ios::binary);
+    if (!out) { errorMessage = "无法写入VTP文件: " + path; return false; }
+
+    // appended raw：每个数组前有 UInt64 字节数，offset 从 '_' 之后起算
+    const uint64_t pointBytes = vertices.size() * sizeof(MCVertex);
+    const uint64_t connBytes = triangles.size() * sizeof(Face);
+    // 单元偏移 K,2K,3,…（K 为角点数）：能放进 UInt32 时用 UInt32，数组更小
+    const bool wideOffsets = triangles.size() * K > UINT32_MAX;
+    const size_t offsetSize = wideOffsets ? sizeof(uint64_t) : sizeof(uint32_t);
+    const uint64_t offsetBytes = triangles.size() * offsetSize;
+    const uint64_t connOffset = sizeof(uint64_t) + pointBytes;
+    const uint64_t offsetsOffset = connOffset + sizeof(uint64_t) + connBytes;
+    const uint64_t normalBytes = normals ? normals->size() * sizeof(MCNormal) : 0;
+    const uint64_t normalsOffset = offsetsOffset + sizeof(uint64_t) + offsetBytes;
 
+    out << "<?xml version=\"1.0\"?>\n";
+    out << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\""
+        << (host_is_big_endian() ? "BigEndian" : "LittleEndian") << "\" header_type=\"UInt64\">\n";
+    out << "  <PolyData>\n";
+    out << "    <Piece NumberOfPoints=\"" << vertices.size() << "\" NumberOfVerts=\"0\" NumberOfLines=\"0\""
+        << " NumberOfStrips=\"0\" NumberOfPolys=\"" << triangles.size() << "\">\n";
+    if (normals) {
+        out << "      <PointData Normals=\"Normals\">\n";
+        out << "        <DataArray type=\"Float32\" Name=\"Normals\" NumberOfComponents=\"3\" format=\"appended\" offset=\""
+            << normalsOffset << "\"/>\n";
+        out << "      </PointData>\n";
+    }
+    out << "      <Points>\n";
+    out << "        <DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"appended\" offset=\"0\"/>\n";
+    out << "      </Points>\n";
+    out << "      <Polys>\n";
+    out << "        <DataArray type=\"UInt32\" Name=\"connectivity\" format=\"appended\" offset=\""
+        << connOffset << "\"/>\n";
+    out << "        <DataArray type=\"" << (wideOffsets ? "UInt64" : "UInt32")
+        << "\" Name=\"offsets\" format=\"appended\" offset=\""
+        << offsetsOffset << "\"/>\n";
+    out << "      </Polys>\n";
+    out << "    </Piece>\n";
+    out << "  </PolyData>\n";
+    out << "  <AppendedData encoding=\"raw\">\n_";
+
+    // 顶点与单元数组本身即为连续的本机字节序数据，直接整块写出
+    out.write(reinterpret_cast<const char *>(&pointBytes), sizeof(pointBytes));
+    out.write(reinterpret_cast<const char *>(vertices.data()), static_cast<std::streamsize>(pointBytes));
+    out.write(reinterpret_cast<const char *>(&connBytes), sizeof(connBytes));
+    out.write(reinterpret_cast<const char *>(triangles.data()), static_cast<std::streamsize>(connBytes));
+    out.write(reinterpret_cast<const char *>(&offsetBytes), sizeof(offsetBytes));
+    write_chunked(out, triangles.size(), numThreads, [&](size_t begin, size_t end, std::string &buf) {
+        buf.resize((end - begin) * offsetSize);
+        char *p = buf.data();
+        for (size_t i = begin; i < end; ++i, p += offsetSize) {
+            const uint64_t offset = (i + 1) * K;
+            if (wideOffsets) {
+                std::memcpy(p, &offset, sizeof(offset));
+            } else {
+                const uint32_t narrow = static_cast<uint32_t>(offset);
+                std::memcpy(p, &narrow, sizeof(narrow));
+            }
+        }
+    });
+    if (normals) {
+        out.write(reinterpret_cast<const char *>(&normalBytes), sizeof(normalBytes));
+        out.write(reinterpret_cast<const char *>(normals->data()), static_cast<std::streamsize>(normalBytes));
+    }
+    out << "\n  </AppendedData>\n";
+    out << "</VTKFile>\n";
+    if (!out) { errorMessage = "写VTP失败: " + path; return false; }
+    return true;
+}
+
+} // namespace
+
+bool write_vtk_legacy_polydata(const std::string &path, const std::vector<MCVertex> &vertices,
+                               const std::vector<MCTriangle> &triangles, std::string &errorMessage,
+                               int numThreads, const std::vector<MCNormal> *normals) {
+    return write_legacy_ascii(path, vertices, triangles, errorMessage, numThreads, normals);
+}
+
+bool write_vtk_legacy_polydata(const std::string &path, const std::vector<MCVertex> &vertices,
+                               const std::vector<MCQuad> &quads, std::string &errorMessage,
+                               int numThreads, const std::vector<MCNormal> *normals) {
+    return write_legacy_ascii(path, vertices, quads, errorMessage, numThreads, normals);
+}
+
+bool write_vtk_legacy_binary(const std::string &path, const std::vector<MCVertex> &vertices,
+                             const std::vector<MCTriangle> &triangles, std::string &errorMessage,
+                             int numThreads, const std::vector<MCNormal> *normals) {
+    return write_legacy_binary(path, vertices, triangles, errorMessage, numThreads, normals);
+}
+
+bool write_vtk_legacy_binary(const std::string &path, const std::vector<MCVertex> &vertices,
+                             const std::vector<MCQuad> &quads, std::string &errorMessage,
+                             int numThreads, const std::vector<MCNormal> *normals) {
+    return write_legacy_binary(path, vertices, quads, errorMessage, numThreads, normals);
+}
+
+bool write_vtp_polydata(const std::string &path, const std::vector<MCVertex> &vertices,
+                        const std::vector<MCTriangle> &triangles, std::string &errorMessage,
+                        int numThreads, const std::vector<MCNormal> *normals) {
+    return write_vtp(path, vertices, triangles, errorMessage, numThreads, normals);
+}
+
+bool write_vtp_polydata(const std::string &path, const std::vector<MCVertex> &vertices,
+                        const std::vector<MCQuad> &quads, std::string &errorMessage,
+                        int numThreads, const std::vector<MCNormal> *normals) {
+    return write_vtp(path, vertices, quads, errorMessage, numThreads, normals);
+}
+
+VtkStreamWriter::~VtkStreamWriter() {
+    stop_writer();
+    remove_spill_files();
+}
+
+bool VtkStreamWriter::open(const std::string &path, std::string &errorMessage) {
+    path_ = path;
+    pointsPath_ = path + ".points.tmp";
+    polysPath_ = path + ".polys.tmp";
+    points_.open(pointsPath_, std::ios::binary);
+    polys_.open(polysPath_, std::ios::binary);
+    if (!points_ || !polys_) {
+        errorMessage = "无法创建临时文件: " + pointsPath_;
+        remove_spill_files();
+        return false;
+    }
+    vertexCount_ = triangleCount_ = 0;
+    closing_ = failed_ = false;
+    writer_ = std::thread([this]() { writer_loop(); });
+    return true;
+}
+
+bool VtkStreamWriter::consume(MCMeshBatch &&batch, std::string &errorMessage) {
+    vertexCount_ += batch.vertices.size();
+    triangleCount_ += batch.triangles.size();
+    {
+        // 队列有上限：写盘跟不上时阻塞提取，内存不随网格增长
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [&]() { return queue_.size() < kMaxQueued || failed_; });
+        if (failed_) { errorMessage = "写VTK临时文件失败: " + path_; return false; }
+        queue_.push_back(std::move(batch));
+    }
+    ready_.notify_one();
+    return true;
+}
+
+void VtkStreamWriter::writer_loop() {
+    std::string text;
+    for (;;) {
+        MCMeshBatch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [&]() { return !queue_.empty() || closing_; });
+            if (queue_.empty()) return;
+            batch = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        space_.notify_one();
+
+        encode_points_ascii(batch.vertices.data(), batch.vertices.size(), text);
+        points_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        encode_faces_ascii(batch.triangles.data(), batch.triangles.size(), text);
+        polys_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!points_ || !polys_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+            space_.notify_all();
+            return;
+        }
+    }
+}
+
+void VtkStreamWriter::stop_writer() {
+    if (!writer_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    ready_.notify_all();
+    writer_.join();
+}
+
+void VtkStreamWriter::remove_spill_files() {
+    if (points_.is_open()) points_.close();
+    if (polys_.is_open()) polys_.close();
+    if (!pointsPath_.empty()) std::remove(pointsPath_.c_str());
+    if (!polysPath_.empty()) std::remove(polysPath_.c_str());
+}
+
+bool VtkStreamWriter::finish(std::string &errorMessage) {
+    stop_writer();
+    points_.close();
+    polys_.close();
+    if (failed_ || points_.fail() || polys_.fail()) { errorMessage = "写VTK临时文件失败: " + path_; return false; }
+
+    std::ofstream out(path_, std::ios::binary);
+    if (!out) { errorMessage = "无法写入VTK文件: " + path_; return false; }
+    std::ifstream points(pointsPath_, std::ios::binary), polys(polysPath_, std::ios::binary);
+    write_legacy_header(out, "ASCII");
+    out << "POINTS " << vertexCount_ << " float\n";
+    if (vertexCount_ > 0) out << points.rdbuf();
+    out << "POLYGONS " << triangleCount_ << " " << triangleCount_ * 4 << "\n";
+    if (triangleCount_ > 0) out << polys.rdbuf();
+    points.close();
+    polys.close();
+    remove_spill_files();
+    if (!out) { errorMessage = "写VTK失败: " + path_; return false; }
+    return true;
+}
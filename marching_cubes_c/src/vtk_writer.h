@@ -3,13 +3,98 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
-struct MCVertex; // forward
-struct MCTriangle; // forward
+#include "marching_cubes.h"
 
+// Mesh writers. Vertex and triangle arrays are encoded in chunks on up to
+// numThreads threads and written with large sequential writes. When normals
+// are given (one per vertex) they are written as point data named "Normals".
+// The legacy and XML writers also accept quads (4-corner polygon cells), as
+// produced by the Surface Nets engine with MCOptions::quads.
+
+// Legacy VTK, ASCII (same text as iostream formatting, via std::to_chars).
 bool write_vtk_legacy_polydata(const std::string &path,
                                const std::vector<MCVertex> &vertices,
                                const std::vector<MCTriangle> &triangles,
-                               std::string &errorMessage);
+                               std::string &errorMessage,
+                               int numThreads = 1,
+                               const std::vector<MCNormal> *normals = nullptr);
+bool write_vtk_legacy_polydata(const std::string &path,
+                               const std::vector<MCVertex> &vertices,
+                               const std::vector<MCQuad> &quads,
+                               std::string &errorMessage,
+                               int numThreads = 1,
+                               const std::vector<MCNormal> *normals = nullptr);
+
+// Legacy VTK, BINARY (big-endian float32 points, int32 polygon cells).
+bool write_vtk_legacy_binary(const std::string &path,
+                             const std::vector<MCVertex> &vertices,
+                             const std::vector<MCTriangle> &triangles,
+                             std::string &errorMessage,
+                             int numThreads = 1,
+                             const std::vector<MCNormal> *normals = nullptr);
+bool write_vtk_legacy_binary(const std::string &path,
+                             const std::vector<MCVertex> &vertices,
+                             const std::vector<MCQuad> &quads,
+                             std::string &errorMessage,
+                             int numThreads = 1,
+                             const std::vector<MCNormal> *normals = nullptr);
+
+// VTK XML PolyData (.vtp) with raw appended data in host byte order; points and
+// connectivity are written straight from the input arrays.
+bool write_vtp_polydata(const std::string &path,
+                        const std::vector<MCVertex> &vertices,
+                        const std::vector<MCTriangle> &triangles,
+                        std::string &errorMessage,
+                        int numThreads = 1,
+                        const std::vector<MCNormal> *normals = nullptr);
+bool write_vtp_polydata(const std::string &path,
+                        const std::vector<MCVertex> &vertices,
+                        const std::vector<MCQuad> &quads,
+                        std::string &errorMessage,
+                        int numThreads = 1,
+                        const std::vector<MCNormal> *normals = nullptr);
+
+// Incremental legacy VTK writer for marching_cubes_streaming().
+// Batches are formatted on a background thread while extraction continues.
+// Points and polygons are spilled to "<path>.points.tmp" / "<path>.polys.tmp"
+// and joined by finish(), so memory stays at a few batches regardless of mesh
+// size. The result is identical to write_vtk_legacy_polydata().
+class VtkStreamWriter : public MCMeshSink {
+public:
+    VtkStreamWriter() = default;
+    ~VtkStreamWriter() override;
+    VtkStreamWriter(const VtkStreamWriter &) = delete;
+    VtkStreamWriter &operator=(const VtkStreamWriter &) = delete;
+
+    bool open(const std::string &path, std::string &errorMessage);
+    bool consume(MCMeshBatch &&batch, std::string &errorMessage) override;
+    // Wait for queued batches and assemble the output file.
+    bool finish(std::string &errorMessage);
+
+    uint64_t vertex_count() const { return vertexCount_; }
+    uint64_t triangle_count() const { return triangleCount_; }
+
+private:
+    static constexpr size_t kMaxQueued = 2;
+
+    void writer_loop();
+    void stop_writer();
+    void remove_spill_files();
 
+    std::string path_, pointsPath_, polysPath_;
+    std::ofstream points_, polys_;
+    uint64_t vertexCount_ = 0, triangleCount_ = 0;
 
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable ready_, space_;
+    std::deque<MCMeshBatch> queue_;
+    bool closing_ = false;
+    bool failed_ = false;
+};
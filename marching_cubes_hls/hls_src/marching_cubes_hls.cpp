@@ -1,6 +1,7 @@
 #include "marching_cubes_hls.h"
 #include "mc_tables.h"
 #include <hls_math.h>
+#include <ap_fixed.h>
 
 // 线性插值
 inline data_t interpolate(data_t v0, data_t v1, data_t iso) {
@@ -12,8 +13,30 @@ inline data_t interpolate(data_t v0, data_t v1, data_t iso) {
     return (iso - v0) / diff;
 }
 
+// uint8输入的线性插值：体素差为-255..255的整数，用定点除法代替浮点除法。
+// ap_fixed的减法与除法结果自动加宽，只在赋值给下列类型时按其量化/溢出模式取舍，因此各级位宽显式给出：
+// 分子iso - v0取18位小数（iso按AP_RND舍入）；商的小数位数与分子相同（向零截断，此处商非负即向下），
+// 再按AP_RND舍入到17位小数。t的误差小于2^-19 + 2^-18 + 2^-18 < 1e-5。
+typedef ap_int<9> interp_diff_t;                                // v1 - v0：-255..255，无舍入
+typedef ap_fixed<28, 10, AP_RND, AP_SAT> interp_num_t;          // iso - v0：穿过等值面的边上|值| <= 256
+typedef ap_ufixed<19, 2, AP_RND, AP_SAT> interp_t;              // t：0..1，17位小数
+inline data_t interpolate(voxel_u8_t v0, voxel_u8_t v1, data_t iso) {
+    #pragma HLS INLINE
+    const interp_diff_t diff = interp_diff_t(v1) - interp_diff_t(v0);
+    if (diff == 0) {
+        return 0.5f;
+    }
+    const interp_num_t num = interp_num_t(iso) - interp_num_t(v0);
+    const interp_t t = num / diff;
+    return t.to_float();
+}
+
+// uint8输入的分类阈值：0..256，v < 阈值即在等值面内侧
+typedef ap_uint<9> threshold_u8_t;
+
 // 计算立方体配置索引
-inline int get_cube_index(const CubeValues& cube, data_t iso) {
+template <typename T, typename Thr>
+inline int get_cube_index(const CubeValues<T>& cube, Thr iso) {
     #pragma HLS INLINE
     int cube_index = 0;
     if (cube.v[0] < iso) cube_index |= 1;
@@ -27,28 +50,55 @@ inline int get_cube_index(const CubeValues& cube, data_t iso) {
     return cube_index;
 }
 
-// 从BRAM缓存获取立方体8个顶点的值
-inline void get_cube_values_from_cache(const data_t cache[2][128][128], 
-                                       int x, int y, int z_offset,
-                                       CubeValues& cube) {
+// 活跃单元记录：分类级 -> 顶点生成级
+template <typename T>
+struct CellRecord {
+    CubeValues<T> cube;
+    int cube_index;
+    int x, y, z;        // 单元最小角点的全局坐标
+    bool last;          // 结束标记
+};
+
+// 三角形记录：顶点生成级 -> 三角形发射级
+struct TriRecord {
+    int cube_index;
+    index_t vert[12];   // 各物理边的顶点编号（活跃边有效）
+    bool last;          // 结束标记
+};
+
+// 物理边最小端点相对单元的偏移与方向（0=x, 1=y, 2=z）
+static const int edge_origin[12][4] = {
+    {0, 0, 0, 0}, {1, 0, 0, 1}, {0, 1, 0, 0}, {0, 0, 0, 1},
+    {0, 0, 1, 0}, {1, 0, 1, 1}, {0, 1, 1, 0}, {0, 0, 1, 1},
+    {0, 0, 0, 2}, {1, 0, 0, 2}, {1, 1, 0, 2}, {0, 1, 0, 2}
+};
+
+// 最低位活跃边的物理边号
+inline int lowest_edge(int edges) {
     #pragma HLS INLINE
-    
-    int z_buf = z_offset & 1;
-    int z_next = (z_offset + 1) & 1;
-    
-    cube.v[0] = cache[z_buf][y][x];
-    cube.v[1] = cache[z_buf][y][x + 1];
-    cube.v[2] = cache[z_buf][y + 1][x + 1];
-    cube.v[3] = cache[z_buf][y + 1][x];
-    cube.v[4] = cache[z_next][y][x];
-    cube.v[5] = cache[z_next][y][x + 1];
-    cube.v[6] = cache[z_next][y + 1][x + 1];
-    cube.v[7] = cache[z_next][y + 1][x];
+    int edge = 0;
+    FIND_EDGE: for (int e = 11; e >= 0; e--) {
+        #pragma HLS UNROLL
+        if (edges & (1 << e)) edge = e;
+    }
+    return edge;
+}
+
+// 物理边edge之前的（拥有的）活跃边数，即该边顶点相对单元第一个新顶点的偏移
+inline int edge_rank(int edges, int edge) {
+    #pragma HLS INLINE
+    int rank = 0;
+    RANK_EDGE: for (int e = 0; e < 12; e++) {
+        #pragma HLS UNROLL
+        if (e < edge && (edges & (1 << e))) rank++;
+    }
+    return rank;
 }
 
 // 计算边上的顶点
+template <typename T>
 Vertex compute_edge_vertex(int x, int y, int z, int edge, 
-                          const CubeValues& cube, data_t iso) {
+                          const CubeValues<T>& cube, data_t iso) {
     #pragma HLS INLINE
     
     // 标准MC边定义
@@ -80,175 +130,557 @@ Vertex compute_edge_vertex(int x, int y, int z, int edge,
     return vertex;
 }
 
-// 加载一个z平面到缓存
-void load_z_plane(const data_t* volume, int nx, int ny, int nz, int z,
-                  data_t cache[128][128]) {
-    #pragma HLS INLINE off
+// 第1级：按(z, y, x)顺序把tile的各z平面逐体素送入流，每行tile_nx个连续体素一次突发读。
+// 与分类级之间的FIFO可容纳一整个平面：分类级读平面z+1（生成第z层单元）时，
+// 本级已经可以把平面z+2完整读入，AXI突发不会因后级反压而中断。
+static void load_planes(const data_t* volume, int nx, int ny, int nz,
+                        int tile_x0, int tile_y0, int tile_nx, int tile_ny,
+                        hls::stream<data_t>& voxels) {
+    LOAD_Z: for (int z = 0; z < nz; z++) {
+        #pragma HLS loop_tripcount min=2 max=600 avg=300
+        int plane_offset = z * ny * nx;
+        LOAD_Y: for (int y = 0; y < tile_ny; y++) {
+            #pragma HLS loop_tripcount min=2 max=128 avg=128
+            int row_offset = plane_offset + (tile_y0 + y) * nx + tile_x0;
+            LOAD_X: for (int x = 0; x < tile_nx; x++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS loop_tripcount min=2 max=128 avg=128
+                voxels.write(volume[row_offset + x]);
+            }
+        }
+    }
+}
+
+// 第1级（uint8）分为读取与拆包两个DATAFLOW进程，以128位字的FIFO相连：读取进程逐行突发读入
+// 覆盖tile_nx个体素的字，拆包进程每周期拆出一个体素。两者并发，下一行的突发与本行的拆包重叠，
+// 每行约tile_nx个周期（不再是读入字数加tile_nx）。行首不必对齐到字边界，从所在字的第shift个体素开始；
+// 一行最多MAX_DIM_U8/16+1个字，两个进程按相同的公式计算每行的字数。
+static void read_rows(const axi_word_t* volume, int nx, int ny, int nz,
+                      int tile_x0, int tile_y0, int tile_nx, int tile_ny,
+                      hls::stream<axi_word_t>& words) {
+    READ_Z: for (int z = 0; z < nz; z++) {
+        #pragma HLS loop_tripcount min=2 max=600 avg=300
+        int plane_offset = z * ny * nx;
+        READ_Y: for (int y = 0; y < tile_ny; y++) {
+            #pragma HLS loop_tripcount min=2 max=256 avg=256
+            int row_offset = plane_offset + (tile_y0 + y) * nx + tile_x0;
+            int first_word = row_offset / VOXELS_PER_WORD;
+            int shift = row_offset % VOXELS_PER_WORD;
+            int num_words = (shift + tile_nx + VOXELS_PER_WORD - 1) / VOXELS_PER_WORD;
+            READ_BURST: for (int w = 0; w < num_words; w++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS loop_tripcount min=1 max=17 avg=17
+                words.write(volume[first_word + w]);
+            }
+        }
+    }
+}
+
+static void unpack_rows(int nx, int ny, int nz,
+                        int tile_x0, int tile_y0, int tile_nx, int tile_ny,
+                        hls::stream<axi_word_t>& words,
+                        hls::stream<voxel_u8_t>& voxels) {
+    UNPACK_Z: for (int z = 0; z < nz; z++) {
+        #pragma HLS loop_tripcount min=2 max=600 avg=300
+        int plane_offset = z * ny * nx;
+        UNPACK_Y: for (int y = 0; y < tile_ny; y++) {
+            #pragma HLS loop_tripcount min=2 max=256 avg=256
+            int shift = (plane_offset + (tile_y0 + y) * nx + tile_x0) % VOXELS_PER_WORD;
+            axi_word_t word = 0;
+            UNPACK_X: for (int x = 0; x < tile_nx; x++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS loop_tripcount min=2 max=256 avg=256
+                int lane = (shift + x) % VOXELS_PER_WORD;
+                // 行首或跨入下一个字时取新字，每行共取num_words个
+                if (x == 0 || lane == 0) word = words.read();
+                voxels.write(voxel_u8_t(word.range(8 * lane + 7, 8 * lane)));
+            }
+        }
+    }
+}
+
+// 第2级：每读入体素(x, y, z)即得到单元(x-1, y-1, z-1)的最后一个角点。
+// 前一平面存于plane_cache[y][x]，读出(y, x)处的旧值后即写入当前平面的值；两个平面的y-1行
+// 另存于行缓存prev_row/cur_row（同样先读后写x处），x-1列的4个角点保存在寄存器里。
+// 每个数组每周期一读一写，下标只取决于(y, x)，II=1。
+// 只把穿过等值面的单元送往下一级（角点值小于threshold为内侧）。
+template <typename T, int DIM, typename Thr>
+static void classify_cells(int nz, int tile_x0, int tile_y0, int tile_nx, int tile_ny,
+                           Thr threshold,
+                           hls::stream<T>& voxels,
+                           hls::stream<CellRecord<T> >& cells) {
+    T plane_cache[DIM][DIM];    // 前一平面
+    T prev_row[DIM];            // 前一平面的y-1行
+    T cur_row[DIM];             // 当前平面的y-1行
+    #pragma HLS BIND_STORAGE variable=plane_cache type=RAM_2P impl=BRAM
+    #pragma HLS BIND_STORAGE variable=prev_row type=RAM_2P impl=LUTRAM
+    #pragma HLS BIND_STORAGE variable=cur_row type=RAM_2P impl=LUTRAM
     
-    // *** 修改：使用 MAX_DIM (128) 限制加载边界 ***
-    if (z >= nz || z >= MAX_DIM) return;
+    CLASSIFY_Z: for (int z = 0; z < nz; z++) {
+        #pragma HLS loop_tripcount min=2 max=600 avg=300
+        CLASSIFY_Y: for (int y = 0; y < tile_ny; y++) {
+            #pragma HLS loop_tripcount min=2 max=128 avg=128
+            // x-1列：前一平面的(y-1, y)与当前平面的(y-1, y)
+            T p_lo = 0, p_hi = 0, c_lo = 0, c_hi = 0;
+            CLASSIFY_X: for (int x = 0; x < tile_nx; x++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS loop_tripcount min=2 max=128 avg=128
+                const T v = voxels.read();
+                const T ph = plane_cache[y][x];
+                const T pl = prev_row[x];
+                const T cl = cur_row[x];
+                plane_cache[y][x] = v;
+                prev_row[x] = ph;
+                cur_row[x] = v;
+                
+                if (x > 0 && y > 0 && z > 0) {
+                    CellRecord<T> cell;
+                    cell.cube.v[0] = p_lo;
+                    cell.cube.v[1] = pl;
+                    cell.cube.v[2] = ph;
+                    cell.cube.v[3] = p_hi;
+                    cell.cube.v[4] = c_lo;
+                    cell.cube.v[5] = cl;
+                    cell.cube.v[6] = v;
+                    cell.cube.v[7] = c_hi;
+                    cell.cube_index = get_cube_index(cell.cube, threshold);
+                    cell.x = tile_x0 + x - 1;
+                    cell.y = tile_y0 + y - 1;
+                    cell.z = z - 1;
+                    cell.last = false;
+                    if (cell.cube_index != 0 && cell.cube_index != 255) cells.write(cell);
+                }
+                
+                p_lo = pl;
+                p_hi = ph;
+                c_lo = cl;
+                c_hi = v;
+            }
+        }
+    }
+    
+    CellRecord<T> end;
+    end.cube_index = 0;
+    end.x = end.y = end.z = 0;
+    end.last = true;
+    cells.write(end);
+}
+
+// 边索引缓存的转发寄存器：保存最近EDGE_FWD_CELLS个活跃单元对一个缓存的写入（每个单元至多1次），
+// 槽0为最近的单元。读缓存时与这些写入比较，命中则取寄存器中的编号（越新的优先）。
+#define EDGE_FWD_CELLS 2
+
+struct EdgeForward {
+    int addr[EDGE_FWD_CELLS];       // 缓存地址，-1为空
+    index_t id[EDGE_FWD_CELLS];
+};
+
+inline void clear_forward(EdgeForward& fwd) {
+    #pragma HLS INLINE
+    CLEAR_FWD: for (int k = 0; k < EDGE_FWD_CELLS; k++) {
+        #pragma HLS UNROLL
+        fwd.addr[k] = -1;
+        fwd.id[k] = 0;
+    }
+}
+
+inline index_t forward_edge(const EdgeForward& fwd, int addr, index_t cached) {
+    #pragma HLS INLINE
+    index_t id = cached;
+    FWD_CMP: for (int k = EDGE_FWD_CELLS - 1; k >= 0; k--) {
+        #pragma HLS UNROLL
+        if (fwd.addr[k] == addr) id = fwd.id[k];
+    }
+    return id;
+}
+
+// 移入一个单元的写入（未写时地址为-1），最旧的单元移出
+inline void push_edge(EdgeForward& fwd, int addr, index_t id) {
+    #pragma HLS INLINE
+    SHIFT_FWD: for (int k = EDGE_FWD_CELLS - 1; k >= 1; k--) {
+        #pragma HLS UNROLL
+        fwd.addr[k] = fwd.addr[k - 1];
+        fwd.id[k] = fwd.id[k - 1];
+    }
+    fwd.addr[0] = addr;
+    fwd.id[0] = id;
+}
+
+// 第3级：每周期输出一个顶点。每条边由按(z, y, x)扫描顺序第一个包含它的单元创建
+// （ownedEdgeTable），其余单元取创建者记下的编号，因此每个顶点只输出一次。
+// 单元(x, y, z)的非新建边来自三处，每个缓存每个单元至多一读一写，下标不随z或y的奇偶切换：
+//   x向边 0/2/4: 第0行的边0取x_row0[x]（下层单元的边4），其余行取x_lo_row[x]（上一行单元的边2）；
+//                边2取x_plane[y+1][x]（下层单元的边6）；边4取x_hi_row[x]（上一行单元的边6）
+//   y向边 1/3/7: 边1取y_plane[y][x+1]（下层单元的边5）；第0列的边3取y_col0[y]（下层单元的边7）；
+//                其余列的边3/7即前一个活跃单元（x-1）的边1/5，保存在寄存器里
+//   z向边 8/9/11: 边9取z_row[x+1]（上一行单元的边10）；边8/11即前一个单元的边9/10（第0列的边8
+//                为上一行第0列单元的边11），均在寄存器里
+// 读入单元时确定全部12条边的编号交给三角形发射级，随后逐条输出拥有的边的顶点。
+// 相邻的活跃单元可能只隔1~2次迭代（每个单元占max(1, 拥有边数)次迭代），前两个单元的写入经
+// 转发寄存器读出。缓存的跨迭代写后读不用DEPENDENCE声明距离，由调度器按实际读写级次保证；
+// VERTEX_LOOP能否保持II=1以csynth报告为准。
+template <typename T, int DIM>
+static void generate_vertices(int tile_x0, int tile_y0, int tile_nx, int tile_ny,
+                              data_t isovalue,
+                              hls::stream<CellRecord<T> >& cells,
+                              hls::stream<TriRecord>& tri_cells,
+                              hls::stream<Vertex>& vertex_stream,
+                              hls::stream<SeamVertex>& seam_stream,
+                              int* num_vertices,
+                              int* num_seam_vertices) {
+    index_t x_plane[DIM][DIM];      // 平面z的x向边（第1行起）
+    index_t x_row0[DIM];            // 平面z第0行的x向边
+    index_t x_lo_row[DIM];          // 平面z第y行的x向边
+    index_t x_hi_row[DIM];          // 平面z+1第y行的x向边
+    index_t y_plane[DIM][DIM];      // 平面z的y向边（第1列起）
+    index_t y_col0[DIM];            // 平面z第0列的y向边
+    index_t z_row[DIM];             // 第y行的z向边
+    #pragma HLS BIND_STORAGE variable=x_plane type=RAM_2P impl=URAM
+    #pragma HLS BIND_STORAGE variable=y_plane type=RAM_2P impl=URAM
+    #pragma HLS BIND_STORAGE variable=x_row0 type=RAM_2P impl=LUTRAM
+    #pragma HLS BIND_STORAGE variable=x_lo_row type=RAM_2P impl=LUTRAM
+    #pragma HLS BIND_STORAGE variable=x_hi_row type=RAM_2P impl=LUTRAM
+    #pragma HLS BIND_STORAGE variable=y_col0 type=RAM_2P impl=LUTRAM
+    #pragma HLS BIND_STORAGE variable=z_row type=RAM_2P impl=LUTRAM
     
-    int plane_offset = z * ny * nx;
-    int y_max = (ny < MAX_DIM) ? ny : MAX_DIM;
-    int x_max = (nx < MAX_DIM) ? nx : MAX_DIM;
+    EdgeForward x_plane_fwd, x_row0_fwd, x_lo_fwd, x_hi_fwd, y_plane_fwd, y_col0_fwd, z_row_fwd;
+    #pragma HLS ARRAY_PARTITION variable=x_plane_fwd.addr complete
+    #pragma HLS ARRAY_PARTITION variable=x_plane_fwd.id complete
+    #pragma HLS ARRAY_PARTITION variable=x_row0_fwd.addr complete
+    #pragma HLS ARRAY_PARTITION variable=x_row0_fwd.id complete
+    #pragma HLS ARRAY_PARTITION variable=x_lo_fwd.addr complete
+    #pragma HLS ARRAY_PARTITION variable=x_lo_fwd.id complete
+    #pragma HLS ARRAY_PARTITION variable=x_hi_fwd.addr complete
+    #pragma HLS ARRAY_PARTITION variable=x_hi_fwd.id complete
+    #pragma HLS ARRAY_PARTITION variable=y_plane_fwd.addr complete
+    #pragma HLS ARRAY_PARTITION variable=y_plane_fwd.id complete
+    #pragma HLS ARRAY_PARTITION variable=y_col0_fwd.addr complete
+    #pragma HLS ARRAY_PARTITION variable=y_col0_fwd.id complete
+    #pragma HLS ARRAY_PARTITION variable=z_row_fwd.addr complete
+    #pragma HLS ARRAY_PARTITION variable=z_row_fwd.id complete
+    clear_forward(x_plane_fwd);
+    clear_forward(x_row0_fwd);
+    clear_forward(x_lo_fwd);
+    clear_forward(x_hi_fwd);
+    clear_forward(y_plane_fwd);
+    clear_forward(y_col0_fwd);
+    clear_forward(z_row_fwd);
     
-    LOAD_Y: for (int y = 0; y < y_max; y++) {
-        #pragma HLS loop_tripcount min=64 max=128 avg=128
-        LOAD_X: for (int x = 0; x < x_max; x++) {
-            #pragma HLS PIPELINE II=1
-            #pragma HLS loop_tripcount min=64 max=128 avg=128
-            cache[y][x] = volume[plane_offset + y * nx + x];
+    // 前一个活跃单元的边1/5/9/10，以及最近一个第0列单元的边11
+    index_t prev_y1 = 0, prev_y5 = 0, prev_z9 = 0, prev_z10 = 0, col0_z11 = 0;
+    
+    int v_count = 0;
+    int s_count = 0;
+    int pending = 0;        // 当前单元尚未输出顶点的拥有边
+    CellRecord<T> cell;
+    
+    VERTEX_LOOP: while (true) {
+        #pragma HLS PIPELINE II=1
+        #pragma HLS loop_tripcount min=1 max=1000000 avg=100000
+        if (pending == 0) {
+            cell = cells.read();
+            if (cell.last) break;
+            
+            const int lx = cell.x - tile_x0;
+            const int ly = cell.y - tile_y0;
+            const int edges = edgeTable[cell.cube_index];
+            const int owned = edges & ownedEdgeTable[(lx == 0 ? 1 : 0) | (ly == 0 ? 2 : 0) | (cell.z == 0 ? 4 : 0)];
+            
+            // 二维缓存的展平地址
+            const int xp_addr = (ly + 1) * DIM + lx;
+            const int yp_addr = ly * DIM + lx + 1;
+            
+            // 拥有的边按物理边号依次取新编号，其余边读缓存（经转发寄存器）或寄存器
+            TriRecord rec;
+            rec.cube_index = cell.cube_index;
+            rec.last = false;
+            index_t id[12];
+            #pragma HLS ARRAY_PARTITION variable=id complete
+            ASSIGN_ID: for (int e = 0; e < 12; e++) {
+                #pragma HLS UNROLL
+                id[e] = v_count + edge_rank(owned, e);
+            }
+            const index_t x0_row0 = forward_edge(x_row0_fwd, lx, x_row0[lx]);
+            const index_t x0_lo = forward_edge(x_lo_fwd, lx, x_lo_row[lx]);
+            const index_t x2 = forward_edge(x_plane_fwd, xp_addr, x_plane[ly + 1][lx]);
+            const index_t x4 = forward_edge(x_hi_fwd, lx, x_hi_row[lx]);
+            const index_t y1 = forward_edge(y_plane_fwd, yp_addr, y_plane[ly][lx + 1]);
+            const index_t y3 = forward_edge(y_col0_fwd, ly, y_col0[ly]);
+            const index_t z9 = forward_edge(z_row_fwd, lx + 1, z_row[lx + 1]);
+            
+            rec.vert[0]  = (owned & 1)    ? id[0]  : (ly == 0 ? x0_row0 : x0_lo);
+            rec.vert[1]  = (owned & 2)    ? id[1]  : y1;
+            rec.vert[2]  = (owned & 4)    ? id[2]  : x2;
+            rec.vert[3]  = (owned & 8)    ? id[3]  : (lx == 0 ? y3 : prev_y1);
+            rec.vert[4]  = (owned & 16)   ? id[4]  : x4;
+            rec.vert[5]  = id[5];
+            rec.vert[6]  = id[6];
+            rec.vert[7]  = (owned & 128)  ? id[7]  : prev_y5;
+            rec.vert[8]  = (owned & 256)  ? id[8]  : (lx == 0 ? col0_z11 : prev_z9);
+            rec.vert[9]  = (owned & 512)  ? id[9]  : z9;
+            rec.vert[10] = id[10];
+            rec.vert[11] = (owned & 2048) ? id[11] : prev_z10;
+            
+            // 每个缓存写一次：供下一行、下一层的单元读取
+            if (ly == 0) x_row0[lx] = rec.vert[4];
+            x_lo_row[lx] = rec.vert[2];
+            x_plane[ly + 1][lx] = rec.vert[6];
+            x_hi_row[lx] = rec.vert[6];
+            y_plane[ly][lx + 1] = rec.vert[5];
+            if (lx == 0) y_col0[ly] = rec.vert[7];
+            z_row[lx + 1] = rec.vert[10];
+            push_edge(x_row0_fwd, ly == 0 ? lx : -1, rec.vert[4]);
+            push_edge(x_lo_fwd, lx, rec.vert[2]);
+            push_edge(x_plane_fwd, xp_addr, rec.vert[6]);
+            push_edge(x_hi_fwd, lx, rec.vert[6]);
+            push_edge(y_plane_fwd, yp_addr, rec.vert[5]);
+            push_edge(y_col0_fwd, lx == 0 ? ly : -1, rec.vert[7]);
+            push_edge(z_row_fwd, lx + 1, rec.vert[10]);
+            
+            prev_y1 = rec.vert[1];
+            prev_y5 = rec.vert[5];
+            prev_z9 = rec.vert[9];
+            prev_z10 = rec.vert[10];
+            if (lx == 0) col0_z11 = rec.vert[11];
+            
+            tri_cells.write(rec);
+            pending = owned;
+            if (pending == 0) continue;
         }
+        
+        const int edge = lowest_edge(pending);
+        vertex_stream.write(compute_edge_vertex(cell.x, cell.y, cell.z, edge, cell.cube, isovalue));
+        
+        // tile侧面上的边（与相邻tile共有）报告给host
+        const int ex = cell.x - tile_x0 + edge_origin[edge][0];
+        const int ey = cell.y - tile_y0 + edge_origin[edge][1];
+        const int axis = edge_origin[edge][3];
+        const bool on_x_face = axis != 0 && (ex == 0 || ex == tile_nx - 1);
+        const bool on_y_face = axis != 1 && (ey == 0 || ey == tile_ny - 1);
+        if (on_x_face || on_y_face) {
+            SeamVertex seam;
+            seam.vertex = v_count;
+            seam.x = tile_x0 + ex;
+            seam.y = tile_y0 + ey;
+            seam.z = cell.z + edge_origin[edge][2];
+            seam.axis = axis;
+            seam_stream.write(seam);
+            s_count++;
+        }
+        
+        v_count++;
+        pending &= pending - 1;
     }
+    
+    TriRecord end;
+    end.cube_index = 0;
+    end.last = true;
+    tri_cells.write(end);
+    *num_vertices = v_count;
+    *num_seam_vertices = s_count;
 }
 
-// 主函数
+// 第4级：每周期输出一个三角形，顶点编号取自单元记录中对应物理边的编号
+static void emit_triangles(hls::stream<TriRecord>& tri_cells,
+                           hls::stream<Triangle>& triangle_stream,
+                           int* num_triangles) {
+    // triTable索引到edgeTable位号的映射
+    static const int edge_index_map[12] = {0,1,2,3,4,5,6,7,8,9,11,10};
+    #pragma HLS ARRAY_PARTITION variable=edge_index_map complete
+    // triTable每行16项重排为一个宽字，每次迭代只读一次ROM
+    #pragma HLS ARRAY_RESHAPE variable=triTable complete dim=2
+    
+    int t_count = 0;
+    int i = 15;             // 当前单元下一个三角形在triTable中的位置，15表示需要读入新单元
+    TriRecord rec;
+    #pragma HLS ARRAY_PARTITION variable=rec.vert complete
+    
+    TRI_LOOP: while (true) {
+        #pragma HLS PIPELINE II=1
+        #pragma HLS loop_tripcount min=1 max=2000000 avg=200000
+        if (i == 15) {
+            rec = tri_cells.read();
+            if (rec.last) break;
+            i = 0;
+        }
+        
+        // 整行读入寄存器，本三角形的3项与下一项的结束检查都从中选取
+        int row[16];
+        #pragma HLS ARRAY_PARTITION variable=row complete
+        TRI_ROW: for (int k = 0; k < 16; k++) {
+            #pragma HLS UNROLL
+            row[k] = triTable[rec.cube_index][k];
+        }
+        
+        Triangle tri;
+        tri.v0 = rec.vert[edge_index_map[row[i]]];
+        tri.v1 = rec.vert[edge_index_map[row[i + 1]]];
+        tri.v2 = rec.vert[edge_index_map[row[i + 2]]];
+        triangle_stream.write(tri);
+        t_count++;
+        
+        i += 3;
+        if (i < 15 && row[i] == -1) i = 15;
+    }
+    
+    *num_triangles = t_count;
+}
+
+// tile尺寸不超过缓存大小（host端按MAX_DIM划分tile，此处只做保护）
+static int clamp_dim(int n, int max_dim) {
+    #pragma HLS INLINE
+    return (n > max_dim) ? max_dim : n;
+}
+
+// uint8的分类阈值：与float版相同的判定 v < isovalue - 1e-6，对整数体素等价于 v < ceil(isovalue - 1e-6)
+static threshold_u8_t u8_threshold(data_t isovalue) {
+    #pragma HLS INLINE
+    const data_t isoBias = isovalue - 1e-6f;
+    if (isoBias <= 0) return 0;
+    if (isoBias > 255) return 256;
+    int t = (int)isoBias;
+    if (t < isoBias) t++;
+    return t;
+}
+
+// float版的DATAFLOW区域：只有流声明与四级进程调用，tile尺寸与分类阈值由调用方算好
+static void dataflow_f32(const data_t* volume, int nx, int ny, int nz,
+                         int tile_x0, int tile_y0, int tile_nx, int tile_ny,
+                         data_t threshold, data_t isovalue,
+                         hls::stream<Vertex>& vertex_stream,
+                         hls::stream<Triangle>& triangle_stream,
+                         hls::stream<SeamVertex>& seam_stream,
+                         int* num_vertices, int* num_triangles, int* num_seam_vertices) {
+    #pragma HLS DATAFLOW
+    
+    hls::stream<data_t> voxels("voxels");
+    hls::stream<CellRecord<data_t> > cells("cells");
+    hls::stream<TriRecord> tri_cells("tri_cells");
+    // 体素FIFO容纳一整个tile平面（乒乓：一个平面被分类时下一个平面已在读入）；
+    // 单元记录的FIFO吸收顶点数不均匀造成的速率差
+    #pragma HLS STREAM variable=voxels depth=16384
+    #pragma HLS BIND_STORAGE variable=voxels type=FIFO impl=BRAM
+    #pragma HLS STREAM variable=cells depth=256
+    #pragma HLS STREAM variable=tri_cells depth=256
+    
+    load_planes(volume, nx, ny, nz, tile_x0, tile_y0, tile_nx, tile_ny, voxels);
+    classify_cells<data_t, MAX_DIM>(nz, tile_x0, tile_y0, tile_nx, tile_ny, threshold, voxels, cells);
+    generate_vertices<data_t, MAX_DIM>(tile_x0, tile_y0, tile_nx, tile_ny, isovalue, cells, tri_cells,
+                                       vertex_stream, seam_stream, num_vertices, num_seam_vertices);
+    emit_triangles(tri_cells, triangle_stream, num_triangles);
+}
+
+// uint8版的DATAFLOW区域：加载级分为读取与拆包两个进程，体素流与平面缓存为8位
+static void dataflow_u8(const axi_word_t* volume, int nx, int ny, int nz,
+                        int tile_x0, int tile_y0, int tile_nx, int tile_ny,
+                        threshold_u8_t threshold, data_t isovalue,
+                        hls::stream<Vertex>& vertex_stream,
+                        hls::stream<Triangle>& triangle_stream,
+                        hls::stream<SeamVertex>& seam_stream,
+                        int* num_vertices, int* num_triangles, int* num_seam_vertices) {
+    #pragma HLS DATAFLOW
+    
+    hls::stream<axi_word_t> words("words");
+    hls::stream<voxel_u8_t> voxels("voxels");
+    hls::stream<CellRecord<voxel_u8_t> > cells("cells");
+    hls::stream<TriRecord> tri_cells("tri_cells");
+    // 字FIFO容纳两行多的字（每行至多17个），读取进程可以在拆包当前行时读完下一行
+    #pragma HLS STREAM variable=words depth=64
+    // 一整个tile平面：256x256个8位体素，共64KB
+    #pragma HLS STREAM variable=voxels depth=65536
+    #pragma HLS BIND_STORAGE variable=voxels type=FIFO impl=BRAM
+    #pragma HLS STREAM variable=cells depth=256
+    #pragma HLS STREAM variable=tri_cells depth=256
+    
+    read_rows(volume, nx, ny, nz, tile_x0, tile_y0, tile_nx, tile_ny, words);
+    unpack_rows(nx, ny, nz, tile_x0, tile_y0, tile_nx, tile_ny, words, voxels);
+    classify_cells<voxel_u8_t, MAX_DIM_U8>(nz, tile_x0, tile_y0, tile_nx, tile_ny, threshold, voxels, cells);
+    generate_vertices<voxel_u8_t, MAX_DIM_U8>(tile_x0, tile_y0, tile_nx, tile_ny, isovalue, cells, tri_cells,
+                                              vertex_stream, seam_stream, num_vertices, num_seam_vertices);
+    emit_triangles(tri_cells, triangle_stream, num_triangles);
+}
+
+// 主函数：四级DATAFLOW，级间以hls::stream相连，各级常见路径II=1。
+// 标量参数在进入DATAFLOW区域前算好，区域内只有流声明与进程调用
 void marching_cubes_hls(
     const data_t* volume,
     int nx, int ny, int nz,
+    int tile_x0, int tile_y0,
+    int tile_nx, int tile_ny,
     data_t isovalue,
     hls::stream<Vertex>& vertex_stream,
     hls::stream<Triangle>& triangle_stream,
+    hls::stream<SeamVertex>& seam_stream,
     int* num_vertices,
-    int* num_triangles
+    int* num_triangles,
+    int* num_seam_vertices
 ) {
-    #pragma HLS INTERFACE m_axi port=volume offset=slave bundle=gmem0 depth=2097152 max_read_burst_length=256
+    #pragma HLS INTERFACE m_axi port=volume offset=slave bundle=gmem0 depth=2097152 max_read_burst_length=256 num_read_outstanding=8
     #pragma HLS INTERFACE axis port=vertex_stream
     #pragma HLS INTERFACE axis port=triangle_stream
+    #pragma HLS INTERFACE axis port=seam_stream
     #pragma HLS INTERFACE s_axilite port=nx
     #pragma HLS INTERFACE s_axilite port=ny
     #pragma HLS INTERFACE s_axilite port=nz
+    #pragma HLS INTERFACE s_axilite port=tile_x0
+    #pragma HLS INTERFACE s_axilite port=tile_y0
+    #pragma HLS INTERFACE s_axilite port=tile_nx
+    #pragma HLS INTERFACE s_axilite port=tile_ny
     #pragma HLS INTERFACE s_axilite port=isovalue
     #pragma HLS INTERFACE s_axilite port=num_vertices
     #pragma HLS INTERFACE s_axilite port=num_triangles
+    #pragma HLS INTERFACE s_axilite port=num_seam_vertices
     #pragma HLS INTERFACE s_axilite port=return
     
-    // BRAM缓存：双缓冲存储两个z平面
-    data_t z_plane_cache[2][128][128];
-    #pragma HLS BIND_STORAGE variable=z_plane_cache type=RAM_T2P impl=BRAM
-    #pragma HLS ARRAY_PARTITION variable=z_plane_cache complete dim=1
-    
-    // triTable索引到edgeTable位号的映射
-    static const int edge_index_map[12] = {0,1,2,3,4,5,6,7,8,9,11,10};
-    #pragma HLS ARRAY_PARTITION variable=edge_index_map complete
+    const int x_bound = clamp_dim(tile_nx, MAX_DIM);
+    const int y_bound = clamp_dim(tile_ny, MAX_DIM);
+    // 使用微小负偏置避免浮点精度导致的裂缝
+    const data_t isoBias = isovalue - 1e-6f;
     
-    int v_count = 0;
-    int t_count = 0;
+    dataflow_f32(volume, nx, ny, nz, tile_x0, tile_y0, x_bound, y_bound, isoBias, isovalue,
+                 vertex_stream, triangle_stream, seam_stream,
+                 num_vertices, num_triangles, num_seam_vertices);
+}
 
-    //确保循环不会超过缓存大小
-    int const x_bound = (nx > MAX_DIM) ? MAX_DIM : nx;
-    int const y_bound = (ny > MAX_DIM) ? MAX_DIM : ny;
-    int const z_bound = (nz > MAX_DIM) ? MAX_DIM : nz;
-    
-    // 预加载第一个z平面
-    load_z_plane(volume, nx, ny, nz, 0, z_plane_cache[0]);
+// uint8输入版本：同样的DATAFLOW，分类阈值在入口换算为整数。
+// tile边长MAX_DIM_U8为float版的2倍：8位的平面缓存与体素FIFO仍在BRAM中，边索引平面缓存放在URAM。
+void marching_cubes_hls_u8(
+    const axi_word_t* volume,
+    int nx, int ny, int nz,
+    int tile_x0, int tile_y0,
+    int tile_nx, int tile_ny,
+    data_t isovalue,
+    hls::stream<Vertex>& vertex_stream,
+    hls::stream<Triangle>& triangle_stream,
+    hls::stream<SeamVertex>& seam_stream,
+    int* num_vertices,
+    int* num_triangles,
+    int* num_seam_vertices
+) {
+    #pragma HLS INTERFACE m_axi port=volume offset=slave bundle=gmem0 depth=524288 max_read_burst_length=256 num_read_outstanding=8
+    #pragma HLS INTERFACE axis port=vertex_stream
+    #pragma HLS INTERFACE axis port=triangle_stream
+    #pragma HLS INTERFACE axis port=seam_stream
+    #pragma HLS INTERFACE s_axilite port=nx
+    #pragma HLS INTERFACE s_axilite port=ny
+    #pragma HLS INTERFACE s_axilite port=nz
+    #pragma HLS INTERFACE s_axilite port=tile_x0
+    #pragma HLS INTERFACE s_axilite port=tile_y0
+    #pragma HLS INTERFACE s_axilite port=tile_nx
+    #pragma HLS INTERFACE s_axilite port=tile_ny
+    #pragma HLS INTERFACE s_axilite port=isovalue
+    #pragma HLS INTERFACE s_axilite port=num_vertices
+    #pragma HLS INTERFACE s_axilite port=num_triangles
+    #pragma HLS INTERFACE s_axilite port=num_seam_vertices
+    #pragma HLS INTERFACE s_axilite port=return
     
-    // 遍历所有立方体
-    Z_LOOP: for (int z = 0; z < z_bound - 1; z++) {
-        #pragma HLS loop_tripcount min=1 max=127 avg=64
-        
-        // 加载下一个z平面到另一个缓冲区
-        int next_z = z + 1;
-        int cache_idx = next_z & 1;
-        load_z_plane(volume, nx, ny, nz, next_z, z_plane_cache[cache_idx]);
-
-        Y_LOOP: for (int y = 0; y < y_bound - 1; y++) {
-            #pragma HLS loop_tripcount min=1 max=127 avg=64
-
-            X_LOOP: for (int x = 0; x < x_bound - 1; x++) {
-                #pragma HLS PIPELINE II=12
-                #pragma HLS loop_tripcount min=1 max=127 avg=64
-                
-                // 从缓存获取立方体值
-                CubeValues cube;
-                #pragma HLS ARRAY_PARTITION variable=cube.v complete
-                get_cube_values_from_cache(z_plane_cache, x, y, z, cube);
-                
-                // 使用微小负偏置避免浮点精度导致的裂缝
-                data_t isoBias = isovalue - 1e-6f;
-                int cube_index = get_cube_index(cube, isoBias);
-                
-                if (cube_index == 0 || cube_index == 255) continue;
-                
-                int edges = edgeTable[cube_index];
-                if (edges == 0) continue;
-                
-                // 按物理边号存储顶点
-                Vertex local_vertices[12];
-                #pragma HLS ARRAY_PARTITION variable=local_vertices complete
-                
-                int vert_map[12];
-                #pragma HLS ARRAY_PARTITION variable=vert_map complete
-                
-                int local_v_count = 0;
-                
-                // 创建顶点
-                EDGE_CREATE: for (int edge = 0; edge < 12; edge++) {
-                    #pragma HLS UNROLL
-                    if (edges & (1 << edge)) {
-                        local_vertices[edge] = compute_edge_vertex(x, y, z, edge, cube, isovalue);
-                        vert_map[edge] = v_count + local_v_count;
-                        local_v_count++;
-                    } else {
-                        vert_map[edge] = -1;
-                    }
-                }
-                
-                // 写入顶点到stream（只写入有效顶点）
-                WRITE_VERTICES: for (int edge = 0; edge < 12; edge++) {
-                    #pragma HLS UNROLL
-                    if (vert_map[edge] >= 0) {
-                        vertex_stream.write(local_vertices[edge]);
-                    }
-                }
-                
-                v_count += local_v_count;
-                
-                // 构建triTable索引视图
-                int triEdgeVert[12];
-                #pragma HLS ARRAY_PARTITION variable=triEdgeVert complete
-                
-                MAP_EDGE: for (int ei = 0; ei < 12; ei++) {
-                    #pragma HLS UNROLL
-                    int bit_idx = edge_index_map[ei];
-                    triEdgeVert[ei] = (edges & (1 << bit_idx)) ? vert_map[bit_idx] : -1;
-                }
-                
-                // 生成三角形
-                TRI_GEN: for (int i = 0; i < 15; i += 3) {
-                    #pragma HLS UNROLL
-                    #pragma HLS loop_tripcount min=0 max=5 avg=2
-                    
-                    int ia = triTable[cube_index][i];
-                    if (ia == -1) break;
-                    
-                    int ib = triTable[cube_index][i + 1];
-                    int ic = triTable[cube_index][i + 2];
-                    
-                    // 验证索引有效性
-                    bool valid = (ib != -1) && (ic != -1) &&
-                                (ia >= 0 && ia <= 11) &&
-                                (ib >= 0 && ib <= 11) &&
-                                (ic >= 0 && ic <= 11) &&
-                                (triEdgeVert[ia] >= 0) &&
-                                (triEdgeVert[ib] >= 0) &&
-                                (triEdgeVert[ic] >= 0);
-                    
-                    if (valid) {
-                        Triangle tri;
-                        tri.v0 = triEdgeVert[ia];
-                        tri.v1 = triEdgeVert[ib];
-                        tri.v2 = triEdgeVert[ic];
-                        triangle_stream.write(tri);
-                        t_count++;
-                    }
-                }
-            }
-        }
-    }
+    const int x_bound = clamp_dim(tile_nx, MAX_DIM_U8);
+    const int y_bound = clamp_dim(tile_ny, MAX_DIM_U8);
+    const threshold_u8_t threshold = u8_threshold(isovalue);
     
-    *num_vertices = v_count;
-    *num_triangles = t_count;
+    dataflow_u8(volume, nx, ny, nz, tile_x0, tile_y0, x_bound, y_bound, threshold, isovalue,
+                vertex_stream, triangle_stream, seam_stream,
+                num_vertices, num_triangles, num_seam_vertices);
 }
 
 // Stream转Memory辅助函数（用于testbench）
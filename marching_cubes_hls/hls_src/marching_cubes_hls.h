@@ -5,7 +5,9 @@
 #include <hls_stream.h>
 
 // 配置参数
-#define MAX_DIM 128
+#define MAX_DIM 128             // 单个tile在x/y方向的最大体素数（含一体素重叠），z方向不受限制
+#define MAX_DIM_U8 256          // uint8输入的tile尺寸：边索引缓存x_plane/y_plane共512KB，放在URAM（xck26共64个，占32个）
+#define VOXELS_PER_WORD 16      // uint8输入每个128位AXI数据拍携带的体素数
 #define MAX_VERTICES 1000000
 #define MAX_TRIANGLES 2000000
 
@@ -13,6 +15,8 @@
 typedef float data_t;
 typedef float vertex_t;
 typedef unsigned int index_t;
+typedef ap_uint<8> voxel_u8_t;      // uint8输入的体素
+typedef ap_uint<128> axi_word_t;    // uint8输入的AXI数据拍：体素i位于[8i+7 : 8i]
 
 // 顶点结构体
 struct Vertex {
@@ -28,20 +32,55 @@ struct Triangle {
     index_t v2;
 };
 
+// tile边界面上的顶点：相邻tile各生成一次，host端按边(axis, x, y, z)合并
+struct SeamVertex {
+    index_t vertex;     // tile内顶点编号
+    int x, y, z;        // 边最小端点的全局坐标
+    int axis;           // 边方向：0=x, 1=y, 2=z
+};
+
 // 立方体顶点值
+template <typename T = data_t>
 struct CubeValues {
-    data_t v[8];
+    T v[8];
 };
 
 // 主函数 - Streaming版本
+// 处理体数据中的一个x/y tile：体素[tile_x0, tile_x0+tile_nx) x [tile_y0, tile_y0+tile_ny)，
+// z方向逐平面流过全部nz个平面。tile_nx/tile_ny不超过MAX_DIM；相邻tile重叠一个体素
+// （步长MAX_DIM-1），使跨tile边界的单元完整。顶点坐标为全体数据坐标，三角形索引
+// 从0开始编号（host端拼接时加上已有顶点数）。
+// tile内每条边的顶点只输出一次（片上边索引缓存共享相邻单元的顶点），编号顺序与CPU
+// marching_cubes()相同。位于tile四个侧面上的顶点另经seam_stream报告，供host合并相邻tile的重复顶点。
 void marching_cubes_hls(
     const data_t* volume,
     int nx, int ny, int nz,
+    int tile_x0, int tile_y0,
+    int tile_nx, int tile_ny,
+    data_t isovalue,
+    hls::stream<Vertex>& vertex_stream,
+    hls::stream<Triangle>& triangle_stream,
+    hls::stream<SeamVertex>& seam_stream,
+    int* num_vertices,
+    int* num_triangles,
+    int* num_seam_vertices
+);
+
+// uint8输入版本：体数据按体素顺序紧密排列，每个128位字依次装16个体素（最后一个字不足部分补零），
+// 逐行突发读入，拆包（每周期一个体素）与下一行的突发并发进行。分类直接比较整数体素值（等价于float版的判定），
+// 插值使用定点运算。tile_nx/tile_ny不超过MAX_DIM_U8（步长MAX_DIM_U8-1），其余参数与输出同上。
+void marching_cubes_hls_u8(
+    const axi_word_t* volume,
+    int nx, int ny, int nz,
+    int tile_x0, int tile_y0,
+    int tile_nx, int tile_ny,
     data_t isovalue,
     hls::stream<Vertex>& vertex_stream,
     hls::stream<Triangle>& triangle_stream,
+    hls::stream<SeamVertex>& seam_stream,
     int* num_vertices,
-    int* num_triangles
+    int* num_triangles,
+    int* num_seam_vertices
 );
 
 // 辅助函数：Stream转Memory（用于输出）
@@ -1,5 +1,10 @@
 #include "mc_tables.h"
 
+// 边5、6、10总是新的；x/y/z为0的单元还拥有相应下表面上的边
+const int ownedEdgeTable[8] = {
+    0x460, 0xce0, 0x670, 0xff0, 0x466, 0xcee, 0x677, 0xfff
+};
+
 const int edgeTable[256] = {
     0x0,  0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
     0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
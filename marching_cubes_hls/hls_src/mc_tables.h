@@ -7,4 +7,8 @@ extern const int edgeTable[256];
 // Triangle table: 256个配置，每个配置最多5个三角形（15个顶点）
 extern const int triTable[256][16];
 
+// 单元创建（拥有）的物理边：按(z, y, x)扫描顺序没有更早的单元包含这些边。
+// 下标为 (x==0) | (y==0)<<1 | (z==0)<<2，坐标为tile内的局部坐标
+extern const int ownedEdgeTable[8];
+
 #endif
@@ -143,11 +143,11 @@ bool NpyReader::readData(std::ifstream& file) {
             data_[i] = static_cast<float>(temp[i]);
         }
     } else if (dtype_ == "|u1" || dtype_ == "u1") {
-        // uint8
-        std::vector<uint8_t> temp(total_elements);
-        file.read(reinterpret_cast<char*>(temp.data()), total_elements * sizeof(uint8_t));
+        // uint8：保留原始字节供uint8内核使用
+        raw_u8_.resize(total_elements);
+        file.read(reinterpret_cast<char*>(raw_u8_.data()), total_elements * sizeof(uint8_t));
         for (size_t i = 0; i < total_elements; i++) {
-            data_[i] = static_cast<float>(temp[i]);
+            data_[i] = static_cast<float>(raw_u8_[i]);
         }
     } else {
         std::cerr << "不支持的数据类型: " << dtype_ << std::endl;
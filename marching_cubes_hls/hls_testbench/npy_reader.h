@@ -16,6 +16,10 @@ public:
     // 获取数据
     const std::vector<float>& getData() const { return data_; }
     
+    // uint8文件的原始数据（其他dtype为空）
+    bool isUint8() const { return !raw_u8_.empty(); }
+    const std::vector<uint8_t>& getRawU8() const { return raw_u8_; }
+    
     // 获取形状
     const std::vector<size_t>& getShape() const { return shape_; }
     
@@ -26,6 +30,7 @@ public:
     
 private:
     std::vector<float> data_;
+    std::vector<uint8_t> raw_u8_;
     std::vector<size_t> shape_;
     std::string dtype_;
     bool fortran_order_;
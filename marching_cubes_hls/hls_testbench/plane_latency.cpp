@@ -0,0 +1,112 @@
+#include "plane_latency.h"
+#include "mc_tables.h"
+#include <iostream>
+#include <iomanip>
+
+// 模型参数：m_axi最大突发256拍，每次突发约64周期访存延迟，最多8个突发并发
+static const int kBurstBeats = 256;
+static const int kAxiReadLatency = 64;
+static const int kReadOutstanding = 8;
+
+static int popcount12(int bits) {
+    int n = 0;
+    for (int e = 0; e < 12; e++) n += (bits >> e) & 1;
+    return n;
+}
+
+static int triangle_count(int cube_index) {
+    int n = 0;
+    for (int i = 0; i < 15 && triTable[cube_index][i] != -1; i += 3) n++;
+    return n;
+}
+
+void estimate_plane_latency(const data_t* volume,
+                            int nx, int ny, int nz,
+                            data_t isovalue,
+                            std::vector<PlaneLatency>& planes,
+                            int max_dim,
+                            int voxels_per_beat) {
+    planes.clear();
+    if (nx < 2 || ny < 2 || nz < 2) return;
+    for (int z = 0; z < nz - 1; z++) planes.push_back({z, 0, 0, 0});
+
+    const data_t isoBias = isovalue - 1e-6f;
+    const int step = max_dim - 1;
+    for (int y0 = 0; y0 < ny - 1; y0 += step) {
+        const int tile_ny = (ny - y0 < max_dim) ? ny - y0 : max_dim;
+        for (int x0 = 0; x0 < nx - 1; x0 += step) {
+            const int tile_nx = (nx - x0 < max_dim) ? nx - x0 : max_dim;
+            const long long row_beats = (tile_nx + voxels_per_beat - 1) / voxels_per_beat;
+            const long long row_bursts = (row_beats + kBurstBeats - 1) / kBurstBeats;
+            // 每拍多个体素时另有拆包进程逐体素送出，与下一行的突发并发，每行取两者中较慢的一个
+            const long long unpack = (voxels_per_beat > 1) ? tile_nx : 0;
+            const long long beats = (row_beats > unpack ? row_beats : unpack) * tile_ny;
+            const long long serial_load = row_bursts * tile_ny * kAxiReadLatency + beats;
+            const long long stream_load = (row_bursts * tile_ny + kReadOutstanding - 1) / kReadOutstanding * kAxiReadLatency + beats;
+
+            for (int z = 0; z < nz - 1; z++) {
+                long long vertices = 0, triangles = 0;
+                for (int y = y0; y < y0 + tile_ny - 1; y++) {
+                    for (int x = x0; x < x0 + tile_nx - 1; x++) {
+                        const data_t* c = volume + ((size_t)z * ny + y) * nx + x;
+                        const size_t plane = (size_t)nx * ny;
+                        const data_t v[8] = {c[0], c[1], c[nx + 1], c[nx],
+                                             c[plane], c[plane + 1], c[plane + nx + 1], c[plane + nx]};
+                        int cube_index = 0;
+                        for (int k = 0; k < 8; k++) if (v[k] < isoBias) cube_index |= 1 << k;
+                        if (cube_index == 0 || cube_index == 255) continue;
+                        // 每个顶点只由拥有该边的单元输出一次
+                        const int owned = ownedEdgeTable[(x == x0 ? 1 : 0) | (y == y0 ? 2 : 0) | (z == 0 ? 4 : 0)];
+                        vertices += popcount12(edgeTable[cube_index] & owned);
+                        triangles += triangle_count(cube_index);
+                    }
+                }
+                long long compute = (long long)tile_nx * tile_ny;
+                if (vertices > compute) compute = vertices;
+                if (triangles > compute) compute = triangles;
+
+                planes[z].serial_load_cycles += serial_load;
+                planes[z].load_cycles += stream_load;
+                planes[z].compute_cycles += compute;
+            }
+        }
+    }
+}
+
+void print_plane_latency(const std::vector<PlaneLatency>& planes) {
+    std::cout << "Per-plane latency (cycles, model: " << kAxiReadLatency << "-cycle AXI latency per "
+              << kBurstBeats << "-beat burst, " << kReadOutstanding << " outstanding bursts, II=1 per stage):" << std::endl;
+    std::cout << std::setw(6) << "layer" << std::setw(12) << "load" << std::setw(12) << "compute"
+              << std::setw(14) << "serialized" << std::setw(14) << "overlapped" << std::setw(12) << "stall" << std::endl;
+
+    long long serialized_total = 0, overlapped_total = 0, load_total = 0, exposed_total = 0;
+    for (size_t i = 0; i < planes.size(); i++) {
+        const PlaneLatency& p = planes[i];
+        // 原结构：先逐行读完平面z+1再生成第z层；重叠：读入与计算并行，只有加载慢于计算的部分暴露
+        const long long serialized = p.serial_load_cycles + p.compute_cycles;
+        const long long overlapped = (p.load_cycles > p.compute_cycles) ? p.load_cycles : p.compute_cycles;
+        const long long stall = overlapped - p.compute_cycles;
+        serialized_total += serialized;
+        overlapped_total += overlapped;
+        load_total += p.load_cycles;
+        exposed_total += stall;
+        std::cout << std::setw(6) << p.z << std::setw(12) << p.load_cycles << std::setw(12) << p.compute_cycles
+                  << std::setw(14) << serialized << std::setw(14) << overlapped << std::setw(12) << stall << std::endl;
+    }
+
+    // 第一个平面在流水线启动前读入，无法隐藏
+    if (!planes.empty()) {
+        serialized_total += planes[0].serial_load_cycles;
+        overlapped_total += planes[0].load_cycles;
+        exposed_total += planes[0].load_cycles;
+        load_total += planes[0].load_cycles;
+    }
+    const long long hidden = load_total - exposed_total;
+    std::cout << "  Total serialized: " << serialized_total << " cycles" << std::endl;
+    std::cout << "  Total overlapped: " << overlapped_total << " cycles" << std::endl;
+    if (load_total > 0) {
+        std::cout << "  Load time hidden: " << hidden << " / " << load_total << " cycles ("
+                  << std::fixed << std::setprecision(1) << 100.0 * hidden / load_total << "%)"
+                  << std::defaultfloat << std::endl;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef PLANE_LATENCY_H
+#define PLANE_LATENCY_H
+
+#include <vector>
+#include "marching_cubes_hls.h"
+
+// 单层的周期估计（所有tile之和）
+struct PlaneLatency {
+    int z;                      // 单元层z（由平面z与z+1组成）
+    long long serial_load_cycles; // 原结构：逐行突发，每行等待访存延迟后才发下一行
+    long long load_cycles;      // 加载级：多个突发并发（num_read_outstanding），延迟互相重叠
+    long long compute_cycles;   // 生成第z层：DATAFLOW各级II=1，取最慢一级
+};
+
+// 按内核结构估算每层的加载（平面z+1）与计算周期。加载按每拍voxels_per_beat个体素加突发访存延迟计
+// （uint8内核每拍16个体素，逐体素拆包与下一行的突发重叠，每行按两者中较慢的计），计算按分类级（每体素一周期）、顶点级（每顶点一周期）、
+// 三角形级（每三角形一周期）中最慢的一级计。tile按max_dim划分，与tile_driver相同。
+void estimate_plane_latency(const data_t* volume,
+                            int nx, int ny, int nz,
+                            data_t isovalue,
+                            std::vector<PlaneLatency>& planes,
+                            int max_dim = MAX_DIM,
+                            int voxels_per_beat = 1);
+
+// 打印逐层表格：串行（先读平面再计算，原结构）与重叠（读平面z+2与计算第z层并行）的对比
+void print_plane_latency(const std::vector<PlaneLatency>& planes);
+
+#endif
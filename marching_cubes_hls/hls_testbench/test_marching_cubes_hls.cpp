@@ -7,15 +7,20 @@
 #include "marching_cubes_hls.h"
 #include "npy_reader.h"
 #include "vtk_writer.h"
+#include "tile_driver.h"
+#include "plane_latency.h"
 
 // 打印使用说明
 void print_usage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " <input.npy> <isovalue> <output.vtk> [--with-normals]" << std::endl;
+    std::cout << "Usage: " << program_name << " <input.npy> <isovalue> <output.vtk> [--with-normals] [--binary] [--latency] [--float]" << std::endl;
     std::cout << "Arguments:" << std::endl;
     std::cout << "  input.npy      : Input NPY volume data file" << std::endl;
     std::cout << "  isovalue       : Isovalue for surface extraction" << std::endl;
     std::cout << "  output.vtk     : Output VTK mesh file" << std::endl;
     std::cout << "  --with-normals : (Optional) Output VTK with normals" << std::endl;
+    std::cout << "  --binary       : (Optional) Output binary legacy VTK (smaller, faster to write)" << std::endl;
+    std::cout << "  --latency      : (Optional) Print per-plane load/compute cycle estimates" << std::endl;
+    std::cout << "  --float        : (Optional) Run uint8 input through the float kernel instead of the uint8 kernel" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << program_name << " data.npy 0.5 output.vtk" << std::endl;
@@ -100,6 +105,52 @@ bool verify_results(const Vertex* vertices, const Triangle* triangles,
     return true;
 }
 
+// uint8内核与float内核对照：两者的分类判定相同，按相同的tile划分（MAX_DIM）运行时顶点顺序与三角形
+// 应完全一致，只有插值不同（定点与浮点）。定点t的误差小于1e-5，坐标另有一次float舍入，
+// 因此每个坐标的容差为2^-16加上该坐标的1个ulp。
+static bool compare_u8_with_float(const std::vector<data_t>& volume, const std::vector<uint8_t>& volume_u8,
+                                  int nx, int ny, int nz, data_t isovalue) {
+    std::vector<Vertex> ref_vertices, u8_vertices;
+    std::vector<Triangle> ref_triangles, u8_triangles;
+    run_marching_cubes_tiled(volume.data(), nx, ny, nz, isovalue, ref_vertices, ref_triangles);
+    run_marching_cubes_tiled_u8(volume_u8.data(), nx, ny, nz, isovalue, u8_vertices, u8_triangles, MAX_DIM);
+    
+    std::cout << "uint8 vs float kernel (tile size " << MAX_DIM << "):" << std::endl;
+    if (u8_vertices.size() != ref_vertices.size() || u8_triangles.size() != ref_triangles.size()) {
+        std::cerr << "Error: uint8 kernel produced " << u8_vertices.size() << " vertices / "
+                  << u8_triangles.size() << " triangles, float kernel " << ref_vertices.size()
+                  << " / " << ref_triangles.size() << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < ref_triangles.size(); i++) {
+        if (u8_triangles[i].v0 != ref_triangles[i].v0 ||
+            u8_triangles[i].v1 != ref_triangles[i].v1 ||
+            u8_triangles[i].v2 != ref_triangles[i].v2) {
+            std::cerr << "Error: Triangle " << i << " differs between uint8 and float kernels" << std::endl;
+            return false;
+        }
+    }
+    
+    const float tol = std::ldexp(1.0f, -16);
+    float max_diff = 0.0f;
+    for (size_t i = 0; i < ref_vertices.size(); i++) {
+        const float ref[3] = {ref_vertices[i].x, ref_vertices[i].y, ref_vertices[i].z};
+        const float got[3] = {u8_vertices[i].x, u8_vertices[i].y, u8_vertices[i].z};
+        for (int k = 0; k < 3; k++) {
+            const float diff = std::fabs(got[k] - ref[k]);
+            const float ulp = std::nextafter(std::fabs(ref[k]), INFINITY) - std::fabs(ref[k]);
+            if (diff > tol + ulp) {
+                std::cerr << "Error: Vertex " << i << " differs by " << diff
+                          << " (tolerance " << tol + ulp << ")" << std::endl;
+                return false;
+            }
+            if (diff > max_diff) max_diff = diff;
+        }
+    }
+    std::cout << "  Topology identical, max vertex difference: " << max_diff << std::endl;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "========================================" << std::endl;
     std::cout << "  Marching Cubes HLS Test (Streaming)" << std::endl;
@@ -111,6 +162,9 @@ int main(int argc, char* argv[]) {
     std::string output_file;
     data_t isovalue = 0.0f;
     bool with_normals = false;
+    bool binary_output = false;
+    bool print_latency = false;
+    bool force_float = false;
     bool use_test_data = false;
     
     if (argc < 2) {
@@ -129,12 +183,20 @@ int main(int argc, char* argv[]) {
         for (int i = 4; i < argc; i++) {
             if (std::strcmp(argv[i], "--with-normals") == 0) {
                 with_normals = true;
+            } else if (std::strcmp(argv[i], "--binary") == 0) {
+                binary_output = true;
+            } else if (std::strcmp(argv[i], "--latency") == 0) {
+                print_latency = true;
+            } else if (std::strcmp(argv[i], "--float") == 0) {
+                force_float = true;
             }
         }
     }
     
     // 加载数据
     std::vector<data_t> volume;
+    std::vector<uint8_t> volume_u8;     // uint8输入：送入uint8内核的原始体素
+    bool use_u8 = false;
     int nx, ny, nz;
     
     // 根据输入加载或生成数据
@@ -163,6 +225,10 @@ int main(int argc, char* argv[]) {
         }
         
         volume = reader.getData();
+        if (reader.isUint8() && !force_float) {
+            volume_u8 = reader.getRawU8();
+            use_u8 = true;
+        }
         const auto& shape = reader.getShape();
         
         // 验证数据维度
@@ -189,71 +255,44 @@ int main(int argc, char* argv[]) {
         std::cout << std::endl;
     }
     
-    // 验证尺寸限制
-    if (nx > MAX_DIM || ny > MAX_DIM || nz > MAX_DIM) {
-        std::cerr << "Error: Data dimensions exceed limit (MAX_DIM=" << MAX_DIM << ")" << std::endl;
-        return 1;
-    }
+    // 运行 Marching Cubes 算法：x/y超过tile尺寸时按tile调度，z方向不受限制。
+    // uint8输入默认使用uint8内核（128位字每拍16个体素，tile边长MAX_DIM_U8）
+    const int tile_dim = use_u8 ? MAX_DIM_U8 : MAX_DIM;
+    std::cout << "Running Marching Cubes algorithm (Streaming, tiled, "
+              << (use_u8 ? "uint8" : "float") << " kernel)..." << std::endl;
     
-    // 分配输出缓冲区
-    std::cout << "Allocating memory..." << std::endl;
-    Vertex* vertices = new Vertex[MAX_VERTICES];
-    Triangle* triangles = new Triangle[MAX_TRIANGLES];
-    
-    if (!vertices || !triangles) {
-        std::cerr << "Error: Failed to allocate memory" << std::endl;
-        if (vertices) delete[] vertices;
-        if (triangles) delete[] triangles;
-        return 1;
-    }
-    
-    std::memset(vertices, 0, MAX_VERTICES * sizeof(Vertex));
-    std::memset(triangles, 0, MAX_TRIANGLES * sizeof(Triangle));
-    
-    // 创建stream对象
-    hls::stream<Vertex> vertex_stream("vertex_stream");
-    hls::stream<Triangle> triangle_stream("triangle_stream");
-    
-    int num_vertices = 0;
-    int num_triangles = 0;
-    
-    // 运行 Marching Cubes 算法
-    std::cout << "Running Marching Cubes algorithm (Streaming)..." << std::endl;
+    std::vector<Vertex> vertex_buffer;
+    std::vector<Triangle> triangle_buffer;
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    // 调用核心算法
-    marching_cubes_hls(
-        volume.data(),
-        nx, ny, nz,
-        isovalue,
-        vertex_stream,
-        triangle_stream,
-        &num_vertices,
-        &num_triangles
-    );
+    int num_tiles = use_u8
+        ? run_marching_cubes_tiled_u8(volume_u8.data(), nx, ny, nz, isovalue,
+                                      vertex_buffer, triangle_buffer)
+        : run_marching_cubes_tiled(volume.data(), nx, ny, nz, isovalue,
+                                   vertex_buffer, triangle_buffer);
     
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     
     std::cout << "Algorithm execution completed!" << std::endl;
+    std::cout << "  Tiles: " << num_tiles << " (tile size <= " << tile_dim << " x " << tile_dim << ")" << std::endl;
     std::cout << "  Execution time: " << duration.count() << " ms" << std::endl;
     std::cout << std::endl;
     
-    // 从stream读取结果到数组
-    std::cout << "Reading results from streams..." << std::endl;
-    
-    for (int i = 0; i < num_vertices; i++) {
-        if (!vertex_stream.empty()) {
-            vertices[i] = vertex_stream.read();
-        }
+    // 逐层周期估计：平面加载与单元处理重叠后隐藏的加载时间
+    if (print_latency) {
+        std::vector<PlaneLatency> planes;
+        estimate_plane_latency(volume.data(), nx, ny, nz, isovalue, planes,
+                               tile_dim, use_u8 ? VOXELS_PER_WORD : 1);
+        print_plane_latency(planes);
+        std::cout << std::endl;
     }
     
-    for (int i = 0; i < num_triangles; i++) {
-        if (!triangle_stream.empty()) {
-            triangles[i] = triangle_stream.read();
-        }
-    }
+    const Vertex* vertices = vertex_buffer.data();
+    const Triangle* triangles = triangle_buffer.data();
+    int num_vertices = static_cast<int>(vertex_buffer.size());
+    int num_triangles = static_cast<int>(triangle_buffer.size());
     
     // 输出结果统计
     std::cout << "Result statistics:" << std::endl;
@@ -285,6 +324,11 @@ int main(int argc, char* argv[]) {
     bool valid = verify_results(vertices, triangles, num_vertices, num_triangles);
     std::cout << std::endl;
     
+    if (valid && use_u8) {
+        valid = compare_u8_with_float(volume, volume_u8, nx, ny, nz, isovalue);
+        std::cout << std::endl;
+    }
+    
     // 保存为VTK文件
     if (valid && num_triangles > 0) {
         std::cout << "Saving VTK file: " << output_file << std::endl;
@@ -298,6 +342,12 @@ int main(int argc, char* argv[]) {
                                             triangles,
                                             num_vertices,
                                             num_triangles);
+        } else if (binary_output) {
+            success = writer.saveBinary(output_file,
+                                        vertices,
+                                        triangles,
+                                        num_vertices,
+                                        num_triangles);
         } else {
             success = writer.save(output_file, 
                                  vertices, 
@@ -313,10 +363,6 @@ int main(int argc, char* argv[]) {
         std::cout << "Warning: No triangles generated or validation failed, skipping VTK save" << std::endl;
     }
     
-    // 释放内存
-    delete[] vertices;
-    delete[] triangles;
-    
     std::cout << std::endl;
     std::cout << "========================================" << std::endl;
     std::cout << "  Test completed!" << std::endl;
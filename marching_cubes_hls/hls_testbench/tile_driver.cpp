@@ -0,0 +1,119 @@
+#include "tile_driver.h"
+#include <cstdint>
+#include <unordered_map>
+
+// 侧面边的全局键：方向与最小端点坐标
+static uint64_t seam_key(const SeamVertex& seam) {
+    return (static_cast<uint64_t>(seam.axis) << 62) |
+           (static_cast<uint64_t>(seam.z) << 40) |
+           (static_cast<uint64_t>(seam.y) << 20) |
+           static_cast<uint64_t>(seam.x);
+}
+
+// tile调度与拼接，kernel(x0, y0, tile_nx, tile_ny, 三个输出流, 三个计数)处理一个tile
+template <typename Kernel>
+static int run_tiled(int max_dim, int nx, int ny, int nz, Kernel kernel,
+                     std::vector<Vertex>& vertices,
+                     std::vector<Triangle>& triangles) {
+    vertices.clear();
+    triangles.clear();
+    if (nx < 2 || ny < 2 || nz < 2) return 0;
+
+    // 每个tile覆盖max_dim-1个单元，最后一个体素与下一个tile共用
+    const int step = max_dim - 1;
+    int tiles = 0;
+    // 已输出的侧面顶点：边 -> 全局编号
+    std::unordered_map<uint64_t, index_t> seam_vertices;
+    std::vector<index_t> remap;
+
+    for (int y0 = 0; y0 < ny - 1; y0 += step) {
+        const int tile_ny = (ny - y0 < max_dim) ? ny - y0 : max_dim;
+        for (int x0 = 0; x0 < nx - 1; x0 += step) {
+            const int tile_nx = (nx - x0 < max_dim) ? nx - x0 : max_dim;
+
+            hls::stream<Vertex> vertex_stream("vertex_stream");
+            hls::stream<Triangle> triangle_stream("triangle_stream");
+            hls::stream<SeamVertex> seam_stream("seam_stream");
+            int num_vertices = 0;
+            int num_triangles = 0;
+            int num_seam_vertices = 0;
+
+            kernel(x0, y0, tile_nx, tile_ny, vertex_stream, triangle_stream, seam_stream,
+                   &num_vertices, &num_triangles, &num_seam_vertices);
+
+            // 侧面顶点：边已由前面的tile输出则复用其编号，否则登记
+            const index_t none = static_cast<index_t>(-1);
+            remap.assign(num_vertices, none);
+            std::vector<SeamVertex> seams(num_seam_vertices);
+            for (int i = 0; i < num_seam_vertices; i++) {
+                seams[i] = seam_stream.read();
+                auto found = seam_vertices.find(seam_key(seams[i]));
+                if (found != seam_vertices.end()) remap[seams[i].vertex] = found->second;
+            }
+
+            // 其余顶点按顺序追加
+            for (int i = 0; i < num_vertices; i++) {
+                const Vertex v = vertex_stream.read();
+                if (remap[i] != none) continue;
+                remap[i] = static_cast<index_t>(vertices.size());
+                vertices.push_back(v);
+            }
+            for (const SeamVertex& seam : seams) {
+                seam_vertices.emplace(seam_key(seam), remap[seam.vertex]);
+            }
+
+            for (int i = 0; i < num_triangles; i++) {
+                Triangle tri = triangle_stream.read();
+                tri.v0 = remap[tri.v0];
+                tri.v1 = remap[tri.v1];
+                tri.v2 = remap[tri.v2];
+                triangles.push_back(tri);
+            }
+            tiles++;
+        }
+    }
+    return tiles;
+}
+
+int run_marching_cubes_tiled(const data_t* volume,
+                             int nx, int ny, int nz,
+                             data_t isovalue,
+                             std::vector<Vertex>& vertices,
+                             std::vector<Triangle>& triangles) {
+    auto kernel = [&](int x0, int y0, int tile_nx, int tile_ny,
+                      hls::stream<Vertex>& vertex_stream,
+                      hls::stream<Triangle>& triangle_stream,
+                      hls::stream<SeamVertex>& seam_stream,
+                      int* num_vertices, int* num_triangles, int* num_seam_vertices) {
+        marching_cubes_hls(volume, nx, ny, nz, x0, y0, tile_nx, tile_ny, isovalue,
+                           vertex_stream, triangle_stream, seam_stream,
+                           num_vertices, num_triangles, num_seam_vertices);
+    };
+    return run_tiled(MAX_DIM, nx, ny, nz, kernel, vertices, triangles);
+}
+
+int run_marching_cubes_tiled_u8(const uint8_t* volume,
+                                int nx, int ny, int nz,
+                                data_t isovalue,
+                                std::vector<Vertex>& vertices,
+                                std::vector<Triangle>& triangles,
+                                int tile_dim) {
+    // 按内核的存储格式打包：每个128位字依次装16个体素，最后一个字补零
+    const size_t total = (size_t)nx * ny * nz;
+    std::vector<axi_word_t> words((total + VOXELS_PER_WORD - 1) / VOXELS_PER_WORD, axi_word_t(0));
+    for (size_t i = 0; i < total; i++) {
+        const int lane = i % VOXELS_PER_WORD;
+        words[i / VOXELS_PER_WORD].range(8 * lane + 7, 8 * lane) = volume[i];
+    }
+
+    auto kernel = [&](int x0, int y0, int tile_nx, int tile_ny,
+                      hls::stream<Vertex>& vertex_stream,
+                      hls::stream<Triangle>& triangle_stream,
+                      hls::stream<SeamVertex>& seam_stream,
+                      int* num_vertices, int* num_triangles, int* num_seam_vertices) {
+        marching_cubes_hls_u8(words.data(), nx, ny, nz, x0, y0, tile_nx, tile_ny, isovalue,
+                              vertex_stream, triangle_stream, seam_stream,
+                              num_vertices, num_triangles, num_seam_vertices);
+    };
+    return run_tiled(tile_dim, nx, ny, nz, kernel, vertices, triangles);
+}
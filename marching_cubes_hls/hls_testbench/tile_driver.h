@@ -0,0 +1,28 @@
+#ifndef TILE_DRIVER_H
+#define TILE_DRIVER_H
+
+#include <vector>
+#include <cstdint>
+#include "marching_cubes_hls.h"
+
+// Host端tile调度：把x/y平面按MAX_DIM划分为重叠一个体素的tile（步长MAX_DIM-1），
+// 逐个调用marching_cubes_hls()，按顺序拼接各tile的网格（三角形索引加上已有顶点数）。
+// 相邻tile共有的侧面边由两个tile各输出一次，按seam_stream报告的边合并为一个顶点，
+// 拼接后每条边只有一个顶点，与CPU marching_cubes()的网格拓扑相同。
+// 返回处理的tile数。
+int run_marching_cubes_tiled(const data_t* volume,
+                             int nx, int ny, int nz,
+                             data_t isovalue,
+                             std::vector<Vertex>& vertices,
+                             std::vector<Triangle>& triangles);
+
+// uint8体数据：按128位字打包后调用marching_cubes_hls_u8()，tile边长tile_dim（不超过MAX_DIM_U8），
+// 拼接方式同上。tile_dim取MAX_DIM时与float版的tile划分相同，两者的输出可逐个顶点比较
+int run_marching_cubes_tiled_u8(const uint8_t* volume,
+                                int nx, int ny, int nz,
+                                data_t isovalue,
+                                std::vector<Vertex>& vertices,
+                                std::vector<Triangle>& triangles,
+                                int tile_dim = MAX_DIM_U8);
+
+#endif
@@ -2,46 +2,68 @@
 #include <fstream>
 #include <iostream>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 
 VtkWriter::VtkWriter() {}
 
 VtkWriter::~VtkWriter() {}
 
+// 追加一个32位值的大端字节
+static void append_be32(std::string& buf, uint32_t v) {
+    buf.push_back(static_cast<char>(v >> 24));
+    buf.push_back(static_cast<char>(v >> 16));
+    buf.push_back(static_cast<char>(v >> 8));
+    buf.push_back(static_cast<char>(v));
+}
+
 bool VtkWriter::save(const std::string& filename,
                      const Vertex* vertices,
                      const Triangle* triangles,
                      int num_vertices,
                      int num_triangles) {
-    std::ofstream file(filename);
+    std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "无法创建文件: " << filename << std::endl;
         return false;
     }
     
+    // 先格式化到内存缓冲区（%g 与 iostream 默认格式一致），最后一次写出
+    std::string buf;
+    buf.reserve(static_cast<size_t>(num_vertices) * 32 + static_cast<size_t>(num_triangles) * 24 + 256);
+    char line[96];
+    
     // 写入VTK头
-    file << "# vtk DataFile Version 3.0\n";
-    file << "Marching Cubes HLS Output\n";
-    file << "ASCII\n";
-    file << "DATASET POLYDATA\n";
+    buf += "# vtk DataFile Version 3.0\n";
+    buf += "Marching Cubes HLS Output\n";
+    buf += "ASCII\n";
+    buf += "DATASET POLYDATA\n";
     
     // 写入顶点
-    file << "POINTS " << num_vertices << " float\n";
+    std::snprintf(line, sizeof(line), "POINTS %d float\n", num_vertices);
+    buf += line;
     for (int i = 0; i < num_vertices; i++) {
-        file << vertices[i].x << " " 
-             << vertices[i].y << " " 
-             << vertices[i].z << "\n";
+        const int n = std::snprintf(line, sizeof(line), "%g %g %g\n",
+                                    vertices[i].x, vertices[i].y, vertices[i].z);
+        buf.append(line, n);
     }
     
     // 写入三角形
-    file << "\nPOLYGONS " << num_triangles << " " << (num_triangles * 4) << "\n";
+    std::snprintf(line, sizeof(line), "\nPOLYGONS %d %d\n", num_triangles, num_triangles * 4);
+    buf += line;
     for (int i = 0; i < num_triangles; i++) {
-        file << "3 " 
-             << triangles[i].v0 << " " 
-             << triangles[i].v1 << " " 
-             << triangles[i].v2 << "\n";
+        const int n = std::snprintf(line, sizeof(line), "3 %u %u %u\n",
+                                    triangles[i].v0, triangles[i].v1, triangles[i].v2);
+        buf.append(line, n);
     }
     
+    file.write(buf.data(), static_cast<std::streamsize>(buf.size()));
     file.close();
+    if (!file) {
+        std::cerr << "写入文件失败: " << filename << std::endl;
+        return false;
+    }
     std::cout << "VTK文件已保存: " << filename << std::endl;
     std::cout << "  顶点数: " << num_vertices << std::endl;
     std::cout << "  三角形数: " << num_triangles << std::endl;
@@ -49,6 +71,63 @@ bool VtkWriter::save(const std::string& filename,
     return true;
 }
 
+bool VtkWriter::saveBinary(const std::string& filename,
+                           const Vertex* vertices,
+                           const Triangle* triangles,
+                           int num_vertices,
+                           int num_triangles) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法创建文件: " << filename << std::endl;
+        return false;
+    }
+    
+    std::string buf;
+    buf.reserve(static_cast<size_t>(num_vertices) * 12 + static_cast<size_t>(num_triangles) * 16 + 256);
+    char line[96];
+    
+    // 写入VTK头
+    buf += "# vtk DataFile Version 3.0\n";
+    buf += "Marching Cubes HLS Output\n";
+    buf += "BINARY\n";
+    buf += "DATASET POLYDATA\n";
+    
+    // 写入顶点（float32 大端）
+    std::snprintf(line, sizeof(line), "POINTS %d float\n", num_vertices);
+    buf += line;
+    for (int i = 0; i < num_vertices; i++) {
+        const float xyz[3] = {vertices[i].x, vertices[i].y, vertices[i].z};
+        for (int k = 0; k < 3; k++) {
+            uint32_t bits;
+            std::memcpy(&bits, &xyz[k], sizeof(bits));
+            append_be32(buf, bits);
+        }
+    }
+    
+    // 写入三角形（int32 大端：3 v0 v1 v2）
+    std::snprintf(line, sizeof(line), "\nPOLYGONS %d %d\n", num_triangles, num_triangles * 4);
+    buf += line;
+    for (int i = 0; i < num_triangles; i++) {
+        append_be32(buf, 3);
+        append_be32(buf, triangles[i].v0);
+        append_be32(buf, triangles[i].v1);
+        append_be32(buf, triangles[i].v2);
+    }
+    buf += "\n";
+    
+    file.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    file.close();
+    if (!file) {
+        std::cerr << "写入文件失败: " << filename << std::endl;
+        return false;
+    }
+    std::cout << "VTK文件（二进制）已保存: " << filename << std::endl;
+    std::cout << "  顶点数: " << num_vertices << std::endl;
+    std::cout << "  三角形数: " << num_triangles << std::endl;
+    
+    return true;
+}
+
 bool VtkWriter::saveWithNormals(const std::string& filename,
                                 const Vertex* vertices,
                                 const Triangle* triangles,
@@ -17,6 +17,13 @@ public:
               int num_vertices,
               int num_triangles);
     
+    // 保存二进制VTK文件（legacy BINARY，大端），整块缓冲后一次写出
+    bool saveBinary(const std::string& filename,
+                    const Vertex* vertices,
+                    const Triangle* triangles,
+                    int num_vertices,
+                    int num_triangles);
+    
     // 保存带法向量的VTK文件
     bool saveWithNormals(const std::string& filename,
                         const Vertex* vertices,